@@ -3,17 +3,22 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
 
 #include "area/area.hpp"
+#include "area/bitplane.hpp"
+#include "area/dijkstra-map.hpp"
+#include "area/pathfind.hpp"
 #include "area/shadowcast.hpp"
 #include "area/tile.hpp"
 #include "codex/codex-tile.hpp"
 #include "core/core.hpp"
 #include "core/game-manager.hpp"
 #include "core/guru.hpp"
+#include "dev/headless.hpp"
+#include "entity/item.hpp"
 #include "entity/monster.hpp"
 #include "entity/player.hpp"
-#include "terminal/terminal.hpp"
 #include "terminal/window.hpp"
 #include "tune/ascii-symbols.hpp"
 #include "ui/ui.hpp"
@@ -23,9 +28,12 @@
 namespace invictus
 {
 
+std::vector<Area*> Area::areas_;    // Every Area currently in memory, so that Tiles can find the Area they belong to.
+std::mutex Area::areas_mutex_;      // Protects areas_, as Areas can be created by the background level generator.
+
 // Constructor, creates a new empty Area.
-Area::Area(int width, int height) : cleanup_done_(false), file_("err"), level_(0), needs_fov_recalc_(true), offset_x_(0), offset_y_(0),
-    player_left_x_(0), player_left_y_(0), size_x_(width), size_y_(height)
+Area::Area(int width, int height) : cleanup_done_(false), file_("err"), fov_radius_(-1), fov_x_(0), fov_y_(0), level_(0), needs_fov_recalc_(true), offset_x_(0), offset_y_(0),
+    player_left_x_(0), player_left_y_(0), size_x_(width), size_y_(height), walk_version_(0)
 {
     if (width < 0 || height < 0) core()->guru()->halt("Invalid Area size", width, height);
     tiles_ = new Tile[width * height]();
@@ -33,18 +41,52 @@ Area::Area(int width, int height) : cleanup_done_(false), file_("err"), level_(0
     std::fill_n(visible_, width * height, false);
     tile_memory_ = new char[width * height];
     std::fill_n(tile_memory_, width * height, ' ');
-    entities_.push_back(core()->game()->player());
+    entity_grid_.resize(width * height);
+    impassable_ = std::make_unique<Bitplane>(width, height);
+    opacity_ = std::make_unique<Bitplane>(width, height);
+    rebuild_planes();
+    std::lock_guard<std::mutex> lock(areas_mutex_);
+    areas_.push_back(this);
+    entities_.insert(core()->game()->player());
+    actors_.push_back(core()->game()->player());
 }
 
 // Destructor, cleans up memory.
 Area::~Area() { cleanup(); }
 
+// Returns the living Mobiles in this Area, the only Entities that ever need ticking.
+const std::vector<std::shared_ptr<Mobile>>* Area::actors() const { return &actors_; }
+
+// Adds an Entity to this Area, at its current coordinates, and returns its handle.
+SlotHandle Area::add_entity(std::shared_ptr<Entity> entity)
+{
+    if (entity->area_) core()->guru()->halt("Attempt to add Entity to multiple Areas: " + entity->name());
+    if (entity->x() >= size_x_ || entity->y() >= size_y_) core()->guru()->halt("Attempt to add Entity outside of Area: " + entity->name(), entity->x(),
+        entity->y());
+    const SlotHandle handle = entities_.insert(entity);
+    index_entity(entity, handle);
+    return handle;
+}
+
+// As above, but into a specific slot, so loaded Entities keep their handles.
+SlotHandle Area::add_entity(std::shared_ptr<Entity> entity, uint32_t slot)
+{
+    if (entity->area_) core()->guru()->halt("Attempt to add Entity to multiple Areas: " + entity->name());
+    if (entity->x() >= size_x_ || entity->y() >= size_y_) core()->guru()->halt("Attempt to add Entity outside of Area: " + entity->name(), entity->x(),
+        entity->y());
+    if (entities_.occupied(slot)) core()->guru()->halt("Attempt to add Entity to an occupied slot: " + entity->name(), slot);
+    const SlotHandle handle = entities_.insert_at(slot, entity);
+    index_entity(entity, handle);
+    return handle;
+}
+
 // Checks if the a Mobile can walk onto a specified tile.
 bool Area::can_walk(int x, int y)
 {
     if (x < 0 || y < 0 || x >= size_x_ || y >= size_y_) return false;
-    if (tile(x, y)->tag(TileTag::BlocksMovement)) return false;
-    for (auto entity : *entities())
+    if (impassable_->get(x, y)) return false;
+    if (core()->game()->player()->blocks_tile(x, y)) return false;
+    for (auto &entity : entities_at(x, y))
         if (entity->blocks_tile(x, y)) return false;
     return true;
 }
@@ -54,6 +96,12 @@ void Area::cleanup()
 {
     if (cleanup_done_) return;
     cleanup_done_ = true;
+    {
+        std::lock_guard<std::mutex> lock(areas_mutex_);
+        areas_.erase(std::remove(areas_.begin(), areas_.end(), this), areas_.end());
+    }
+    for (auto &entity : entities_)
+        if (entity->area_ == this) entity->area_ = nullptr;
     if (tiles_)
     {
         delete[] tiles_;
@@ -71,12 +119,54 @@ void Area::cleanup()
     }
 }
 
-// Returns the vector of Entities within this Area.
-std::vector<std::shared_ptr<Entity>>* Area::entities() { return &entities_; }
+// Returns every Entity within this Area, including the player.
+const SlotMap<std::shared_ptr<Entity>>* Area::entities() const { return &entities_; }
+
+// Returns the Entities on a specified tile, not including the player.
+const std::vector<std::shared_ptr<Entity>>& Area::entities_at(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= size_x_ || y >= size_y_) core()->guru()->halt("Invalid map tile requested!", x, y);
+    return entity_grid_.at(x + (y * size_x_));
+}
+
+// Returns the Entities within a rectangle, not including the player.
+std::vector<std::shared_ptr<Entity>> Area::entities_in_rect(int x, int y, int w, int h) const
+{
+    std::vector<std::shared_ptr<Entity>> result;
+    const int x1 = std::max(x, 0), y1 = std::max(y, 0), x2 = std::min(x + w, static_cast<int>(size_x_)), y2 = std::min(y + h, static_cast<int>(size_y_));
+    for (int ry = y1; ry < y2; ry++)
+    {
+        for (int rx = x1; rx < x2; rx++)
+        {
+            auto &bucket = entity_grid_.at(rx + (ry * size_x_));
+            result.insert(result.end(), bucket.begin(), bucket.end());
+        }
+    }
+    return result;
+}
 
-// Finds an Entity's index on the list of Entities.
-uint32_t Area::entity_index(std::shared_ptr<Entity> entity)
-{ return std::distance(entities()->begin(), std::find(entities()->begin(), entities()->end(), entity)); }
+// Retrieves an Entity by its handle, or nullptr if it's no longer in this Area.
+std::shared_ptr<Entity> Area::entity(SlotHandle handle) const
+{
+    auto entity = entities_.get(handle);
+    return (entity ? *entity : nullptr);
+}
+
+// Updates the spatial index when an Entity moves. Called by Entity::set_pos().
+void Area::entity_moved(Entity* entity, int old_x, int old_y)
+{
+    if (old_x < 0 || old_y < 0 || old_x >= size_x_ || old_y >= size_y_ || entity->x() >= size_x_ || entity->y() >= size_y_)
+        core()->guru()->halt("Entity moved outside of Area: " + entity->name(), entity->x(), entity->y());
+    auto &old_bucket = entity_grid_.at(old_x + (old_y * size_x_));
+    for (unsigned int i = 0; i < old_bucket.size(); i++)
+    {
+        if (old_bucket.at(i).get() != entity) continue;
+        entity_grid_.at(entity->x() + (entity->y() * size_x_)).push_back(old_bucket.at(i));
+        old_bucket.erase(old_bucket.begin() + i);
+        return;
+    }
+    core()->guru()->nonfatal("Could not find " + entity->name() + " in the spatial index!", GURU_ERROR);
+}
 
 // Returns the filename section for this Area, without modificiation.
 std::string Area::file_str() const { return file_; }
@@ -100,7 +190,7 @@ float Area::fov_distance(int x, int y, int x2, int y2)
     auto bresenham = std::make_unique<BresenhamLine>(x, y, x2, y2);
     do
     {
-        if (tile(x, y)->tag(TileTag::BlocksLight) && (x != x2 || y != y2)) return -1;
+        if (is_opaque(x, y) && (x != x2 || y != y2)) return -1;
         std::pair<int, int> result = bresenham->step();
         x = result.first;
         y = result.second;
@@ -122,6 +212,41 @@ float Area::grid_distance(int x, int y, int x2, int y2) const
 // Read-only access to the Area's height.
 uint16_t Area::height() const { return size_y_; }
 
+// Checks if any awake, hostile Monster is within the player's field of view.
+bool Area::hostile_in_fov()
+{
+    recalc_fov();
+    for (auto &monster : monsters_)
+        if (!monster->is_dead() && monster->is_awake() && !monster->tag(EntityTag::Passive) && monster->is_in_fov()) return true;
+    return false;
+}
+
+// Retrieves the packed map of which tiles block movement.
+const Bitplane* Area::impassable_plane() const { return impassable_.get(); }
+
+// Adds a newly-stored Entity to the spatial index and typed lists.
+void Area::index_entity(std::shared_ptr<Entity> entity, SlotHandle handle)
+{
+    entity_grid_.at(entity->x() + (entity->y() * size_x_)).push_back(entity);
+    entity->area_ = this;
+    entity->handle_ = handle;
+
+    // Each Entity is also sorted by type, and items and corpses never do anything, so only living Mobiles are added to the list of actors.
+    switch(entity->type())
+    {
+        case EntityType::ITEM: items_.push_back(std::static_pointer_cast<Item>(entity)); break;
+        case EntityType::MONSTER:
+        {
+            auto monster = std::static_pointer_cast<Monster>(entity);
+            monsters_.push_back(monster);
+            if (!monster->is_dead()) actors_.push_back(monster);
+            break;
+        }
+        case EntityType::PLAYER: actors_.push_back(std::static_pointer_cast<Mobile>(entity)); break;
+        default: break;
+    }
+}
+
 // Checks if a given Tile is within the player's field of view.
 uint8_t Area::is_in_fov(int x, int y)
 {
@@ -135,10 +260,9 @@ uint8_t Area::is_in_fov(int x, int y)
 bool Area::is_item_stack(int x, int y)
 {
     bool something_here = false;
-    for (auto entity : entities_)
+    for (auto &entity : entities_at(x, y))
     {
-        if (!entity->is_at(x, y)) continue;
-        if (entity->type() == EntityType::ITEM || (entity->type() == EntityType::MONSTER && std::dynamic_pointer_cast<Mobile>(entity)->is_dead()))
+        if (entity->type() == EntityType::ITEM || (entity->type() == EntityType::MONSTER && static_cast<const Mobile*>(entity.get())->is_dead()))
         {
             if (something_here) return true;
             else something_here = true;
@@ -150,15 +274,41 @@ bool Area::is_item_stack(int x, int y)
 // Checks if a given Tile is blocking light.
 bool Area::is_opaque(int x, int y)
 {
-    if (tile(x, y)->tag(TileTag::BlocksLight)) return true;
-    return false;
+    if (x < 0 || y < 0 || x >= size_x_ || y >= size_y_) core()->guru()->halt("Invalid map tile requested!", x, y);
+    return opacity_plane()->get(x, y);
 }
 
+// Checks if any Entity at all, including the player, is on a specified tile.
+bool Area::is_occupied(int x, int y) const
+{
+    if (core()->game()->player()->is_at(x, y)) return true;
+    return entities_at(x, y).size();
+}
+
+// Returns every Item in this Area.
+const std::vector<std::shared_ptr<Item>>& Area::items() const { return items_; }
+
 // Returns the vertical level of this Area.
 int Area::level() const { return level_; }
 
-// Marks the Area as needing a FoV recalc.
-void Area::need_fov_recalc() { needs_fov_recalc_ = true; }
+// Returns every Monster in this Area, living or dead.
+const std::vector<std::shared_ptr<Monster>>& Area::monsters() const { return monsters_; }
+
+// Marks the Area as needing a FoV recalc, if needed.
+void Area::need_fov_recalc(FovChange cause, int x, int y)
+{
+    switch(cause)
+    {
+        case FovChange::COSMETIC: break;    // Visible tiles are drawn as they are anyway, and the player's memory of them is updated in recalc_fov().
+        case FovChange::OPACITY:
+            // An opacity change can't affect anything the player sees if it's further away than they can see. The extra tile allows for the way
+            // shadowcasting treats the edge of the radius.
+            if (fov_radius_ >= 0 && x >= 0 && y >= 0 && (std::abs(x - fov_x_) > fov_radius_ + 1 || std::abs(y - fov_y_) > fov_radius_ + 1)) break;
+            needs_fov_recalc_ = true;
+            break;
+        case FovChange::FULL: needs_fov_recalc_ = true; break;
+    }
+}
 
 // Retrieves the view offset on the X axis.
 int Area::offset_x() const { return offset_x_; }
@@ -166,23 +316,101 @@ int Area::offset_x() const { return offset_x_; }
 // Retrieves the view offset on the Y axis.
 int Area::offset_y() const { return offset_y_; }
 
-// Recalculates the player's field of view.
+// Retrieves the packed map of which tiles block light.
+const Bitplane* Area::opacity_plane() const { return opacity_.get(); }
+
+// Retrieves the scratch grid used for pathfinding in this Area.
+PathfindGrid* Area::pathfind_grid()
+{
+    if (!pathfind_grid_) pathfind_grid_ = std::make_unique<PathfindGrid>(size_x_, size_y_);
+    return pathfind_grid_.get();
+}
+
+// Retrieves the distance map leading to the player, recalculating it if needed.
+DijkstraMap* Area::player_distance_map()
+{
+    auto player = core()->game()->player();
+    if (!player_distance_map_) player_distance_map_ = std::make_unique<DijkstraMap>(size_x_, size_y_);
+    if (!player_distance_map_->is_current(player->x(), player->y(), walk_version_))
+        player_distance_map_->recalc(this, player->x(), player->y(), walk_version_);
+    return player_distance_map_.get();
+}
+
+// Rebuilds the opacity and impassability maps from scratch.
+void Area::rebuild_planes()
+{
+    for (int i = 0; i < size_x_ * size_y_; i++)
+        update_planes(i);
+}
+
+// Recalculates the player's field of view, if anything has changed since it was last calculated.
 void Area::recalc_fov()
 {
-    if (!needs_fov_recalc_) return;
+    auto player = core()->game()->player();
+    const int px = player->x(), py = player->y(), radius = player->fov_radius();
+    if (!needs_fov_recalc_ && px == fov_x_ && py == fov_y_ && radius == fov_radius_) return;
+    DevHeadless::Scope timer(HeadlessTimer::FOV);
 
-    std::fill_n(visible_, size_x_ * size_y_, false);
-    auto game = core()->game();
-    auto player = game->player();
-    Shadowcast::calc_fov(this, player->x(), player->y(), player->fov_radius());
+    // Nothing outside of the last field of view's radius can be visible, so there's no need to clear the whole Area. Tiles that were visible can
+    // also have the player's memory of them updated here, in case they've changed cosmetically since they were last seen.
+    if (fov_radius_ >= 0)
+    {
+        const int x1 = std::max(fov_x_ - fov_radius_, 0), x2 = std::min(fov_x_ + fov_radius_, size_x_ - 1);
+        const int y1 = std::max(fov_y_ - fov_radius_, 0), y2 = std::min(fov_y_ + fov_radius_, size_y_ - 1);
+        for (int y = y1; y <= y2; y++)
+        {
+            for (int x = x1; x <= x2; x++)
+            {
+                const int index = x + (y * size_x_);
+                if (!visible_[index]) continue;
+                visible_[index] = false;
+                tile_memory_[index] = tiles_[index].ascii();
+            }
+        }
+    }
 
+    Shadowcast::calc_fov(opacity_plane(), visible_, px, py, radius);
+    const int x1 = std::max(px - radius, 0), x2 = std::min(px + radius, size_x_ - 1);
+    const int y1 = std::max(py - radius, 0), y2 = std::min(py + radius, size_y_ - 1);
+    for (int y = y1; y <= y2; y++)
+    {
+        for (int x = x1; x <= x2; x++)
+        {
+            const int index = x + (y * size_x_);
+            if (visible_[index]) tile_memory_[index] = tiles_[index].ascii();
+        }
+    }
+    fov_radius_ = radius;
+    fov_x_ = px;
+    fov_y_ = py;
     needs_fov_recalc_ = false;
 }
 
+// Removes a Mobile from the list of actors, once it has died.
+void Area::remove_actor(Mobile* mob)
+{ actors_.erase(std::remove_if(actors_.begin(), actors_.end(), [mob](const std::shared_ptr<Mobile> &actor) { return actor.get() == mob; }), actors_.end()); }
+
+// Removes an Entity from this Area, by its handle.
+void Area::remove_entity(SlotHandle handle)
+{
+    auto entity = this->entity(handle);
+    if (!entity) core()->guru()->halt("Attempt to remove invalid Entity handle.", handle.index, handle.generation);
+    if (entity->type() == EntityType::PLAYER) core()->guru()->halt("Attempt to remove the player from an Area!");
+    entities_.erase(handle);
+    if (entity->type() == EntityType::ITEM) items_.erase(std::remove(items_.begin(), items_.end(), entity), items_.end());
+    else if (entity->type() == EntityType::MONSTER)
+    {
+        monsters_.erase(std::remove(monsters_.begin(), monsters_.end(), entity), monsters_.end());
+        remove_actor(static_cast<Mobile*>(entity.get()));
+    }
+    auto &bucket = entity_grid_.at(entity->x() + (entity->y() * size_x_));
+    bucket.erase(std::remove(bucket.begin(), bucket.end(), entity), bucket.end());
+    entity->area_ = nullptr;
+}
+
 // Renders this Area on the screen.
 void Area::render()
 {
-    auto terminal = core()->terminal();
     auto player = core()->game()->player();
     auto dungeon_view = core()->game()->ui()->dungeon_view();
 
@@ -206,81 +434,70 @@ void Area::render()
     }
     else if (size_y_ < visible_y) offset_y_ = -((visible_y - size_y_) / 2);
 
-    for (int x = 0; x < size_x_; x++)
+    // Only the part of the map inside the view is drawn, a row at a time, so the cost of a redraw depends on the size of the screen, not the map.
+    const int x_start = std::max(0, offset_x_), x_end = std::min<int>(size_x_, offset_x_ + visible_x);
+    const int y_start = std::max(0, offset_y_), y_end = std::min<int>(size_y_, offset_y_ + visible_y);
+    const int player_index = player->x() + (player->y() * size_x_);
+    for (int y = y_start; y < y_end; y++)
     {
-        int ox = x - offset_x_;
-        if (ox < 0 || ox >= visible_x) continue;
-        for (int y = 0; y < size_y_; y++)
+        const int row = y * size_x_, oy = y - offset_y_;
+        const Tile *tile_row = tiles_ + row;
+        const bool *visible_row = visible_ + row;
+        const char *memory_row = tile_memory_ + row;
+        for (int x = x_start; x < x_end; x++)
         {
-            int oy = y - offset_y_;
-            if (oy < 0 || oy >= visible_y) continue;
-
-            auto the_tile = tile(x, y);
-            bool is_visible = is_in_fov(x, y);
-            char tile_memory = tile_memory_[x + (y * size_x_)];
-            bool is_explored = (tile_memory != ' ');
-            if (!is_visible && !is_explored) continue;
-
-            Colour colour = the_tile->colour();
-            char ascii = the_tile->ascii();
-            if (!is_visible)
-            {
-                colour = Colour::BLUE;
-                ascii = tile_memory;
-            }
-            terminal->put(ascii, ox, oy, colour, 0, dungeon_view);
+            // The player's own tile always counts as visible, as with is_in_fov().
+            if (visible_row[x] || row + x == player_index) dungeon_view->set_cell(tile_row[x].ascii(), x - offset_x_, oy, tile_row[x].colour());
+            else if (memory_row[x] != ' ') dungeon_view->set_cell(memory_row[x], x - offset_x_, oy, Colour::BLUE);
         }
     }
 
-    // We'll render Actors in several passes, to ensure more important things are on top.
+    // We'll render Actors in several passes, to ensure more important things are on top. Each type of Entity is kept on its own list, so each pass
+    // only has to look at the Entities it cares about.
+    auto on_screen = [this, visible_x, visible_y](const Entity *entity, int *ox, int *oy) -> bool {
+        *ox = entity->x() - offset_x_;
+        *oy = entity->y() - offset_y_;
+        return (*ox >= 0 && *oy >= 0 && *ox < visible_x && *oy < visible_y);
+    };
+    int ox = 0, oy = 0;
 
     // First pass: Corpses.
-    for (auto entity : entities_)
+    for (auto &monster : monsters_)
     {
-        if (entity->type() != EntityType::MONSTER || !entity->is_in_fov()) continue;
-        const int ox = entity->x() - offset_x(), oy = entity->y() - offset_y();
-        if (ox < 0 || oy < 0 || ox >= visible_x || oy >= visible_y) continue;
-        auto mob = std::dynamic_pointer_cast<Mobile>(entity);
-        if (!mob->is_dead()) continue;
-        int ascii = mob->ascii();
-        Colour colour = mob->colour();
-        if (is_item_stack(entity->x(), entity->y()))
+        if (!monster->is_dead() || !on_screen(monster.get(), &ox, &oy) || !monster->is_in_fov()) continue;
+        int ascii = monster->ascii();
+        Colour colour = monster->colour();
+        if (is_item_stack(monster->x(), monster->y()))
         {
             ascii = ASCII_STACK;
             colour = Colour::MAGENTA;
         }
-        terminal->put(ascii, ox, oy, colour, 0, dungeon_view);
+        dungeon_view->set_cell(ascii, ox, oy, colour);
     }
 
     // Second pass: Items.
-    for (auto entity : entities_)
+    for (auto &item : items_)
     {
-        if (entity->type() != EntityType::ITEM || !entity->is_in_fov()) continue;
-        const int ox = entity->x() - offset_x(), oy = entity->y() - offset_y();
-        if (ox < 0 || oy < 0 || ox >= visible_x || oy >= visible_y) continue;
-        int ascii = entity->ascii();
-        Colour colour = entity->colour();
-        if (is_item_stack(entity->x(), entity->y()))
+        if (!on_screen(item.get(), &ox, &oy) || !item->is_in_fov()) continue;
+        int ascii = item->ascii();
+        Colour colour = item->colour();
+        if (is_item_stack(item->x(), item->y()))
         {
             ascii = ASCII_STACK;
             colour = Colour::MAGENTA;
         }
-        terminal->put(ascii, ox, oy, colour, 0, dungeon_view);
+        dungeon_view->set_cell(ascii, ox, oy, colour);
     }
 
     // Third pass: Monsters.
-    for (auto entity : entities_)
+    for (auto &monster : monsters_)
     {
-        if (entity->type() != EntityType::MONSTER || !entity->is_in_fov()) continue;
-        const int ox = entity->x() - offset_x(), oy = entity->y() - offset_y();
-        if (ox < 0 || oy < 0 || ox >= visible_x || oy >= visible_y) continue;
-        auto mob = std::dynamic_pointer_cast<Monster>(entity);
-        if (mob->is_dead()) continue;
-        terminal->put(mob->ascii(), ox, oy, mob->colour(), 0, dungeon_view);
+        if (monster->is_dead() || !on_screen(monster.get(), &ox, &oy) || !monster->is_in_fov()) continue;
+        dungeon_view->set_cell(monster->ascii(), ox, oy, monster->colour());
     }
 
     // Fourth pass: the player. No need for off-screen checks here, the player should always be on the screen.
-    terminal->put(player->ascii(), player->x() - offset_x_, player->y() - offset_y_, player->colour(), 0, dungeon_view);
+    dungeon_view->set_cell(player->ascii(), player->x() - offset_x_, player->y() - offset_y_, player->colour());
 }
 
 // Sets the filename for this Area.
@@ -302,6 +519,8 @@ void Area::set_tile(int x, int y, TileID tile_id)
 {
     if (x < 0 || y < 0 || x >= width() || y >= height()) core()->guru()->halt("Invalid map tile requested!", x, y);
     CodexTile::generate(&tiles_[x + (y * size_x_)], tile_id);
+    update_planes(x + (y * size_x_));
+    walk_version_++;
 }
 
 // Sets a specified Tile as visible.
@@ -326,14 +545,54 @@ char Area::tile_memory(int x, int y)
     return tile_memory_[x + (y * size_x_)];
 }
 
+// Updates the opacity and impassability maps for a Tile, if it belongs to any Area.
+void Area::tile_planes_changed(const Tile* tile)
+{
+    // Tiles don't know which Area they're in, but there are very few Areas in memory at any one time, so it's cheap enough to check them all.
+    // Tiles that aren't part of any Area (such as the ones used by the dungeon generator's Rooms) are simply ignored.
+    std::less<const Tile*> before;
+    std::lock_guard<std::mutex> lock(areas_mutex_);
+    for (auto area : areas_)
+    {
+        if (before(tile, area->tiles_) || !before(tile, area->tiles_ + (area->size_x_ * area->size_y_))) continue;
+        const int index = tile - area->tiles_, x = index % area->size_x_, y = index / area->size_x_;
+        const bool was_impassable = area->impassable_->get(x, y), was_opaque = area->opacity_->get(x, y);
+        area->update_planes(index);
+        if (was_impassable != area->impassable_->get(x, y)) area->walk_version_++;
+        if (was_opaque != area->opacity_->get(x, y)) area->need_fov_recalc(FovChange::OPACITY, x, y);
+        return;
+    }
+}
+
+// Updates the opacity and impassability maps for a specified tile index.
+void Area::update_planes(int index)
+{
+    const int x = index % size_x_, y = index / size_x_;
+    const Tile &the_tile = tiles_[index];
+    impassable_->set(x, y, the_tile.tag(TileTag::BlocksMovement));
+    opacity_->set(x, y, the_tile.tag(TileTag::BlocksLight));
+}
+
 // Erases this entire Area.
 void Area::void_area()
 {
     for (int i = 0; i < size_x_ * size_y_; i++)
         CodexTile::generate(&tiles_[i], TileID::VOID_TILE);
+    for (auto &entity : entities_)
+        if (entity->area_ == this) entity->area_ = nullptr;
     entities_.clear();
-    entities_.push_back(core()->game()->player());
+    entities_.insert(core()->game()->player());
+    items_.clear();
+    monsters_.clear();
+    actors_.clear();
+    actors_.push_back(core()->game()->player());
+    for (auto &bucket : entity_grid_)
+        bucket.clear();
+    walk_version_++;
     std::fill_n(visible_, size_x_ * size_y_, false);
+    fov_radius_ = -1;
+    needs_fov_recalc_ = true;
+    rebuild_planes();
     std::fill_n(tile_memory_, size_x_ * size_y_, ' ');
 }
 
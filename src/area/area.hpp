@@ -6,10 +6,13 @@
 
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "util/slot-map.hpp"
+
 
 namespace invictus
 {
@@ -17,7 +20,21 @@ namespace invictus
 enum class TileID : uint16_t;   // defined in factory/factory-tile.hpp
 enum class TileTag : uint16_t;  // defined in area/tile.hpp
 
+// The reasons a field-of-view recalculation might be needed. The player moving, or their light radius changing, is detected automatically.
+enum class FovChange : uint8_t
+{
+    COSMETIC,   // Something changed that doesn't affect what the player can see (e.g. blood splashes). This never triggers a recalculation.
+    OPACITY,    // A tile changed whether or not it blocks light (e.g. a door opening). Ignored if it's out of the player's sight radius.
+    FULL,       // Something else changed, and the field of view must be recalculated regardless.
+};
+
+class Bitplane;     // defined in area/bitplane.hpp
+class DijkstraMap;  // defined in area/dijkstra-map.hpp
 class Entity;   // defined in entity/entity.hpp
+class Item;     // defined in entity/item.hpp
+class Mobile;   // defined in entity/mobile.hpp
+class Monster;  // defined in entity/monster.hpp
+class PathfindGrid; // defined in area/pathfind.hpp
 class Tile;     // defined in area/tile.hpp
 
 
@@ -26,10 +43,15 @@ class Area
 public:
                 Area(int width, int height);    // Constructor, creates a new empty Area.
                 ~Area();    // Destructor, cleans up memory.
+    const std::vector<std::shared_ptr<Mobile>>* actors() const; // Returns the living Mobiles in this Area, the only Entities that ever need ticking.
+    SlotHandle  add_entity(std::shared_ptr<Entity> entity); // Adds an Entity to this Area, at its current coordinates, and returns its handle.
     bool        can_walk(int x, int y); // Checks if the a Mobile can walk onto a specified tile.
     void        cleanup();  // Cleans up memory used.
-    std::vector<std::shared_ptr<Entity>>*   entities(); // Returns the vector of Entities within this Area.
-    uint32_t    entity_index(std::shared_ptr<Entity> entity);   // Finds an Entity's index on the list of Entities.
+    const SlotMap<std::shared_ptr<Entity>>*     entities() const;   // Returns every Entity within this Area, including the player.
+    const std::vector<std::shared_ptr<Entity>>& entities_at(int x, int y) const;    // Returns the Entities on a specified tile, not including the player.
+    std::vector<std::shared_ptr<Entity>>    entities_in_rect(int x, int y, int w, int h) const; // Returns the Entities within a rectangle, not including the player.
+    std::shared_ptr<Entity> entity(SlotHandle handle) const;    // Retrieves an Entity by its handle, or nullptr if it's no longer in this Area.
+    void        entity_moved(Entity* entity, int old_x, int old_y); // Updates the spatial index when an Entity moves. Called by Entity::set_pos().
     std::string file_str() const;   // Returns the filename section for this Area, without modificiation.
     std::string filename() const;   // Returns the full filename for this Area to be saved.
     std::pair<int, int> find_tile_tag(TileTag tag);             // Finds a tile with the specified tag.
@@ -37,13 +59,24 @@ public:
     std::pair<uint16_t, uint16_t>   get_player_left();          // Get the coordinates where the Player last left this area.
     float       grid_distance(int x, int y, int x2, int y2) const;  // Calculates the distance between two points, regardless of line of sight.
     uint16_t    height() const;     // Read-only access to the Area's height.
+    bool        hostile_in_fov();   // Checks if any awake, hostile Monster is within the player's field of view.
     uint8_t     is_in_fov(int x, int y);        // Checks if a given Tile is within the player's field of view.
     bool        is_item_stack(int x, int y);    // Returns true if at least two items (corpses are counted as items) occupy this grid square.
     bool        is_opaque(int x, int y);        // Checks if a given Tile is blocking light.
+    bool        is_occupied(int x, int y) const;    // Checks if any Entity at all, including the player, is on a specified tile.
+    const std::vector<std::shared_ptr<Item>>&   items() const;  // Returns every Item in this Area.
     int         level() const;      // Returns the vertical level of this Area.
-    void        need_fov_recalc();  // Marks the Area as needing a FoV recalc.
+    const std::vector<std::shared_ptr<Monster>>&    monsters() const;   // Returns every Monster in this Area, living or dead.
+    void        need_fov_recalc(FovChange cause = FovChange::FULL, int x = -1, int y = -1);    // Marks the Area as needing a FoV recalc, if needed.
     int         offset_x() const;   // Retrieves the view offset on the X axis.
     int         offset_y() const;   // Retrieves the view offset on the Y axis.
+    const Bitplane* opacity_plane() const;  // Retrieves the packed map of which tiles block light.
+    const Bitplane* impassable_plane() const;   // Retrieves the packed map of which tiles block movement.
+    PathfindGrid*   pathfind_grid();    // Retrieves the scratch grid used for pathfinding in this Area.
+    DijkstraMap*    player_distance_map();  // Retrieves the distance map leading to the player, recalculating it if needed.
+    void        recalc_fov();       // Recalculates the player's field of view, if anything has changed since it was last calculated.
+    void        remove_actor(Mobile* mob);  // Removes a Mobile from the list of actors, once it has died.
+    void        remove_entity(SlotHandle handle);   // Removes an Entity from this Area, by its handle.
     void        render();           // Renders this Area on the screen.
     void        set_file(const std::string &file);  // Sets the filename for this Area.
     void        set_level(int level);   // Sets the vertical level of this Area.
@@ -56,21 +89,41 @@ public:
     uint16_t    width() const;      // Read-only access to the Area's width.
 
 private:
-    void        recalc_fov();       // Recalculates the player's field of view.
+    SlotHandle  add_entity(std::shared_ptr<Entity> entity, uint32_t slot);  // As above, but into a specific slot, so loaded Entities keep their handles.
+    void        index_entity(std::shared_ptr<Entity> entity, SlotHandle handle);    // Adds a newly-stored Entity to the spatial index and typed lists.
+    void        rebuild_planes();   // Rebuilds the opacity and impassability maps from scratch.
+    static void tile_planes_changed(const Tile* tile);  // Updates the opacity and impassability maps for a Tile, if it belongs to any Area.
+    void        update_planes(int index);   // Updates the opacity and impassability maps for a specified tile index.
+
+    static std::vector<Area*>   areas_; // Every Area currently in memory, so that Tiles can find the Area they belong to.
+    static std::mutex   areas_mutex_;   // Protects areas_, as Areas can be created by the background level generator.
 
+    std::vector<std::shared_ptr<Mobile>>    actors_;    // The living Mobiles within this Area, in the order they were added.
     bool        cleanup_done_;      // Has the cleanup routine already run once?
-    std::vector<std::shared_ptr<Entity>>    entities_;  // The Entities within this Area.
+    SlotMap<std::shared_ptr<Entity>>    entities_;  // The Entities within this Area. The player is always in the first slot.
+    std::vector<std::vector<std::shared_ptr<Entity>>>   entity_grid_;   // Spatial index of the Entities on each tile. The player is shared between every
+                                                                        // Area, so isn't part of this, and is always checked separately.
     std::string file_;  // Part of the filename used to save this Area to disk.
+    std::unique_ptr<Bitplane>   impassable_;    // Packed map of which tiles block movement.
+    std::vector<std::shared_ptr<Item>>  items_; // The Items within this Area, kept apart from the other Entities so they can be looped over without casting.
+    int         fov_radius_;    // The radius used for the last field-of-view calculation, or -1 if there wasn't one.
+    int         fov_x_, fov_y_; // The origin of the last field-of-view calculation.
     int         level_; // The vertical level of this Area.
+    std::vector<std::shared_ptr<Monster>>   monsters_;  // The Monsters within this Area, including dead ones, kept apart in the same way.
     bool        needs_fov_recalc_;  // Set this to TRUE to force a field-of-view recalculation on the next render.
     int         offset_x_, offset_y_;   // Screen rendering offsets.
+    std::unique_ptr<Bitplane>   opacity_;   // Packed map of which tiles block light.
+    std::unique_ptr<PathfindGrid>   pathfind_grid_; // Scratch memory for pathfinding, created the first time it's needed.
+    std::unique_ptr<DijkstraMap>    player_distance_map_;   // The distance map leading to the player, shared by all Monsters hunting them.
     uint16_t    player_left_x_, player_left_y_; // The X/Y coordinates of where the Player left this Area for another.
     uint16_t    size_x_, size_y_;   // The X/Y dimensions of this Area.
     char*       tile_memory_;   // The player's memory of previously-seen Tiles.
     Tile*       tiles_;     // An array of Tiles that make up this Area.
     bool*       visible_;   // Which tiles are currently visible by the player.
+    uint32_t    walk_version_;  // Incremented every time a Tile changes in a way that might affect walkability.
 
 friend class SaveLoad;
+friend class Tile;
 };
 
 }       // namespace invictus
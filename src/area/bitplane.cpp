@@ -0,0 +1,34 @@
+// area/bitplane.cpp -- Packed one-bit-per-tile maps of an Area, for fast and cache-friendly spatial queries.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#include <algorithm>
+
+#include "area/bitplane.hpp"
+
+
+namespace invictus
+{
+
+// Constructor, creates a new Bitplane with every bit cleared.
+Bitplane::Bitplane(int width, int height) : size_x_(width), size_y_(height), words_per_row_((width + 63) / 64)
+{ words_.resize(words_per_row_ * height, 0); }
+
+// Clears every bit on this Bitplane.
+void Bitplane::clear() { std::fill(words_.begin(), words_.end(), 0); }
+
+// Read-only access to the Bitplane's height.
+uint16_t Bitplane::height() const { return size_y_; }
+
+// Sets or clears a specified bit. Coordinates are not bounds-checked.
+void Bitplane::set(int x, int y, bool value)
+{
+    const uint64_t bit = 1ULL << (x & 63);
+    uint64_t &word = words_[(y * words_per_row_) + (x >> 6)];
+    if (value) word |= bit;
+    else word &= ~bit;
+}
+
+// Read-only access to the Bitplane's width.
+uint16_t Bitplane::width() const { return size_x_; }
+
+}   // namespace invictus
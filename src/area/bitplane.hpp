@@ -0,0 +1,33 @@
+// area/bitplane.hpp -- Packed one-bit-per-tile maps of an Area, for fast and cache-friendly spatial queries.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef AREA_BITPLANE_HPP_
+#define AREA_BITPLANE_HPP_
+
+#include <cstdint>
+#include <vector>
+
+
+namespace invictus
+{
+
+class Bitplane
+{
+public:
+                Bitplane(int width, int height);    // Constructor, creates a new Bitplane with every bit cleared.
+    void        clear();    // Clears every bit on this Bitplane.
+    uint16_t    height() const; // Read-only access to the Bitplane's height.
+    void        set(int x, int y, bool value);  // Sets or clears a specified bit. Coordinates are not bounds-checked.
+    uint16_t    width() const;  // Read-only access to the Bitplane's width.
+
+    // Checks if a specified bit is set. Coordinates are not bounds-checked. This is defined here so it can be inlined into hot loops.
+    bool        get(int x, int y) const { return (words_[(y * words_per_row_) + (x >> 6)] >> (x & 63)) & 1; }
+
+private:
+    uint16_t                size_x_, size_y_;   // The X/Y dimensions of this Bitplane.
+    std::vector<uint64_t>   words_;     // The bits themselves. Each row starts on a new word, so rows can be processed a word at a time.
+    int                     words_per_row_; // The number of 64-bit words used by each row.
+};
+
+}       // namespace invictus
+#endif  // AREA_BITPLANE_HPP_
@@ -0,0 +1,109 @@
+// area/dijkstra-map.cpp -- Dijkstra distance maps, which allow any number of Mobiles to home in on a single goal with one flood fill.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#include <algorithm>
+
+#include "area/area.hpp"
+#include "area/bitplane.hpp"
+#include "area/dijkstra-map.hpp"
+#include "entity/entity.hpp"
+#include "tune/pathfind.hpp"
+
+
+namespace invictus
+{
+
+// Constructor, sets up an empty distance map of the given size.
+DijkstraMap::DijkstraMap(int width, int height) : distance_(width * height, UNREACHABLE), goal_x_(-1), goal_y_(-1), size_x_(width), size_y_(height),
+    walk_version_(0) { }
+
+// Picks the best step towards the goal from the given tile, or {0,0} if there is none.
+std::pair<int, int> DijkstraMap::descend(Area* area, int x, int y) const
+{
+    std::pair<int, int> best_step = {0, 0};
+    float best_score = UNREACHABLE;
+    for (int dx = -1; dx <= 1; dx++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            if (dx == 0 && dy == 0) continue;
+            const int nx = x + dx, ny = y + dy;
+            if (nx < 0 || ny < 0 || nx >= size_x_ || ny >= size_y_) continue;
+            float score = distance_.at(nx + (ny * size_x_));
+            if (score >= UNREACHABLE) continue;
+            score += ((dx == 0 || dy == 0) ? PATHFIND_TRAVEL_COST_STRAIGHT : PATHFIND_TRAVEL_COST_DIAGONAL);
+
+            // Other Monsters in the way make this route more costly. Only the tiles right next to us matter, so this is a lot cheaper than
+            // accounting for other Monsters in the flood fill itself.
+            for (auto &entity : area->entities_at(nx, ny))
+            {
+                if (entity->type() != EntityType::MONSTER || !entity->blocks_tile(nx, ny)) continue;
+                score += PATHFIND_ALLY_BLOCKER_COST;
+                break;
+            }
+            if (score < best_score)
+            {
+                best_score = score;
+                best_step = {dx, dy};
+            }
+        }
+    }
+    return best_step;
+}
+
+// Checks the travel distance from a given tile to the goal.
+float DijkstraMap::distance(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= size_x_ || y >= size_y_) return UNREACHABLE;
+    return distance_.at(x + (y * size_x_));
+}
+
+// Checks if this map is up to date for the given goal.
+bool DijkstraMap::is_current(int goal_x, int goal_y, uint32_t walk_version) const
+{ return (goal_x == goal_x_ && goal_y == goal_y_ && walk_version == walk_version_); }
+
+// Floods the map outwards from a goal tile.
+void DijkstraMap::recalc(Area* area, int goal_x, int goal_y, uint32_t walk_version)
+{
+    goal_x_ = goal_x;
+    goal_y_ = goal_y;
+    walk_version_ = walk_version;
+    std::fill(distance_.begin(), distance_.end(), UNREACHABLE);
+    if (goal_x < 0 || goal_y < 0 || goal_x >= size_x_ || goal_y >= size_y_) return;
+
+    // The open list is a binary min-heap of {distance, tile index} pairs. Stale entries are left in the heap and skipped when they come up.
+    auto heap_order = [](const std::pair<float, uint32_t> &a, const std::pair<float, uint32_t> &b) -> bool { return a.first > b.first; };
+    const Bitplane* impassable = area->impassable_plane();
+    const uint32_t goal_index = goal_x + (goal_y * size_x_);
+    distance_.at(goal_index) = 0;
+    open_list_.clear();
+    open_list_.push_back({0, goal_index});
+
+    while (open_list_.size())
+    {
+        std::pop_heap(open_list_.begin(), open_list_.end(), heap_order);
+        const std::pair<float, uint32_t> current = open_list_.back();
+        open_list_.pop_back();
+        if (current.first > distance_.at(current.second)) continue;
+
+        const int current_x = current.second % size_x_, current_y = current.second / size_x_;
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                if (dx == 0 && dy == 0) continue;
+                const int nx = current_x + dx, ny = current_y + dy;
+                if (nx < 0 || ny < 0 || nx >= size_x_ || ny >= size_y_) continue;
+                const uint32_t index = nx + (ny * size_x_);
+                const float new_distance = current.first + ((dx == 0 || dy == 0) ? PATHFIND_TRAVEL_COST_STRAIGHT : PATHFIND_TRAVEL_COST_DIAGONAL);
+                if (new_distance >= distance_.at(index)) continue;
+                if (impassable->get(nx, ny)) continue;
+                distance_.at(index) = new_distance;
+                open_list_.push_back({new_distance, index});
+                std::push_heap(open_list_.begin(), open_list_.end(), heap_order);
+            }
+        }
+    }
+}
+
+}   // namespace invictus
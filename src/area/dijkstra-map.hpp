@@ -0,0 +1,38 @@
+// area/dijkstra-map.hpp -- Dijkstra distance maps, which allow any number of Mobiles to home in on a single goal with one flood fill.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef AREA_DIJKSTRA_MAP_HPP_
+#define AREA_DIJKSTRA_MAP_HPP_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+namespace invictus
+{
+
+class Area; // defined in area/area.hpp
+
+
+class DijkstraMap
+{
+public:
+    static constexpr float  UNREACHABLE = 999999999.0f; // The distance given to tiles which cannot reach the goal at all.
+
+                            DijkstraMap(int width, int height); // Constructor, sets up an empty distance map of the given size.
+    std::pair<int, int>     descend(Area* area, int x, int y) const;    // Picks the best step towards the goal from the given tile, or {0,0} if there is none.
+    float                   distance(int x, int y) const;   // Checks the travel distance from a given tile to the goal.
+    bool                    is_current(int goal_x, int goal_y, uint32_t walk_version) const;    // Checks if this map is up to date for the given goal.
+    void                    recalc(Area* area, int goal_x, int goal_y, uint32_t walk_version);  // Floods the map outwards from a goal tile.
+
+private:
+    std::vector<float>      distance_;      // The travel distance from each tile to the goal.
+    int                     goal_x_, goal_y_;   // The goal tile this map was last flooded from.
+    std::vector<std::pair<float, uint32_t>> open_list_; // The Dijkstra open list, kept as a binary heap and reused between floods.
+    uint16_t                size_x_, size_y_;   // The X/Y dimensions of this map.
+    uint32_t                walk_version_;  // The Area's walkability version at the time this map was last flooded.
+};
+
+}       // namespace invictus
+#endif  // AREA_DIJKSTRA_MAP_HPP_
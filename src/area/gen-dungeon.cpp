@@ -14,14 +14,14 @@
 #include "core/guru.hpp"
 #include "entity/monster.hpp"
 #include "tune/area-generation.hpp"
-#include "util/random.hpp"
 
 
 namespace invictus
 {
 
-// Prepares a Map for procedural generation.
-DungeonGenerator::DungeonGenerator(std::shared_ptr<Area> area_to_gen) : active_room_(-1), area_(area_to_gen), first_room_(true), stairs_up_room_(-1) { }
+// Prepares an Area for procedural generation, with a given random seed.
+DungeonGenerator::DungeonGenerator(std::shared_ptr<Area> area_to_gen, uint32_t seed) : active_room_(-1), area_(area_to_gen), first_room_(true), rng_(seed),
+    stairs_up_room_(-1) { }
 
 // Decorates a specified room.
 void DungeonGenerator::decorate_room(unsigned int room_id)
@@ -55,7 +55,7 @@ bool DungeonGenerator::decorate_room_druj_tombs(unsigned int room_id)
                     neighbours(check_x, check_y, TileID::LG_WALL, false) >= 3 && neighbours(check_x, check_y, TileID::LG_FLOOR, false) == 1 &&
                     area_->tile(check_x + tomb_offset_x, check_y + tomb_offset_y)->id() == TileID::LG_WALL && area_->tile(check_x + tomb_offset_x +
                     diag_check_x, check_y + tomb_offset_y + diag_check_y)->id() == TileID::LG_WALL && area_->tile(check_x + tomb_offset_x - diag_check_x,
-                    check_y + tomb_offset_y - diag_check_y)->id() == TileID::LG_WALL && Random::rng(TOMB_WALL_TOMB_CHANCE) == 1)
+                    check_y + tomb_offset_y - diag_check_y)->id() == TileID::LG_WALL && rng(TOMB_WALL_TOMB_CHANCE) == 1)
             {
                 area_->set_tile(check_x, check_y, TileID::DRUJ_TOMB);
                 success = true;
@@ -121,8 +121,10 @@ void DungeonGenerator::generate()
     if (AREA_GEN_DEBUG_MESSAGES) guru->log("Beginning dungeon generation.");
     while (failed_rooms < DUNGEON_ROOM_GEN_RETRIES)
     {
-        auto new_room = std::make_shared<Room>(this, Random::rng(DUNGEON_ROOM_SIZE_MIN, DUNGEON_ROOM_SIZE_MAX),
-            Random::rng(DUNGEON_ROOM_SIZE_MIN, DUNGEON_ROOM_SIZE_MAX));
+        // The order in which function arguments are evaluated isn't fixed, so the room size is rolled separately to keep generation deterministic.
+        const int room_width = rng(DUNGEON_ROOM_SIZE_MIN, DUNGEON_ROOM_SIZE_MAX);
+        const int room_height = rng(DUNGEON_ROOM_SIZE_MIN, DUNGEON_ROOM_SIZE_MAX);
+        auto new_room = std::make_shared<Room>(this, room_width, room_height);
         new_room->generate(first_room_);
 
         if (first_room_)
@@ -172,7 +174,7 @@ void DungeonGenerator::generate()
         int found_x = -1, found_y = -1;
         while (possible_locations.size())
         {
-            int choice = Random::rng(possible_locations.size()) - 1;
+            int choice = rng(possible_locations.size()) - 1;
             auto loc = possible_locations.at(choice);
             if (paste_room(new_room, loc.first, loc.second))
             {
@@ -286,7 +288,7 @@ void DungeonGenerator::generate()
             for (int y = 0; y < area_->height(); y++)
             {
                 if (area_->tile(x, y)->id() == TileID::LG_FLOOR && neighbours(x, y, TileID::LG_WALL, true) >= 5 &&
-                    Random::rng(DUNGEON_ROOM_CORNER_SMOOTHING) == 1)
+                    rng(DUNGEON_ROOM_CORNER_SMOOTHING) == 1)
                 {
                     area_->set_tile(x, y, TileID::LG_WALL);
                     corners_smoothed++;
@@ -353,7 +355,7 @@ void DungeonGenerator::generate()
             }
             if (possible_stair_locations.size())
             {
-                int choice = Random::rng(possible_stair_locations.size()) - 1;
+                int choice = rng(possible_stair_locations.size()) - 1;
                 area_->set_tile(possible_stair_locations.at(choice).first, possible_stair_locations.at(choice).second, up ? TileID::STAIRS_UP :
                     TileID::STAIRS_DOWN);
                 if (up) stairs_up_room_ = current_room;
@@ -393,7 +395,7 @@ void DungeonGenerator::generate()
                     chosen_tile = TileID::DRUJ_TOMB;
                     auto new_mob = CodexMonster::generate(MonsterID::DRUJ_WALKER);
                     new_mob->set_pos(x, y);
-                    area_->entities()->push_back(new_mob);
+                    area_->add_entity(new_mob);
                     break;
                 }
                 default: break;
@@ -454,6 +456,16 @@ bool DungeonGenerator::paste_room(std::shared_ptr<Room> room, int x, int y)
     return true;
 }
 
+// Generates a random number between, and including, the two specified values.
+unsigned int DungeonGenerator::rng(unsigned int min, unsigned int max)
+{
+    if (min >= max) return min;
+    return min + rng_.bounded(max - min + 1);
+}
+
+// As above, but with an implied minimum number of 1.
+unsigned int DungeonGenerator::rng(unsigned int max) { return rng(1, max); }
+
 // Voids (empties) this entire map.
 void DungeonGenerator::void_map()
 {
@@ -500,7 +512,7 @@ void Room::apply_door_candidate(int sx, int sy, int dx, int dy)
     }
     if (viable_options.size())
     {
-        auto target = viable_options.at(Random::rng(viable_options.size()) - 1);
+        auto target = viable_options.at(dungeon_gen_->rng(viable_options.size()) - 1);
         set_tile(target.first, target.second, TileID::LG_DOOR_CANDIDATE);
     }
 }
@@ -580,7 +592,7 @@ bool Room::generate(bool first)
             void_room();
         }
     } while (!viable);
-    int door_candidates = (first ? 15 : Random::rng(15));
+    int door_candidates = (first ? 15 : dungeon_gen_->rng(15));
     if ((door_candidates & 1) == 1) apply_door_candidate(0, 0, 1, 0);
     if ((door_candidates & 2) == 2) apply_door_candidate(width_ - 1, 0, -1, 0);
     if ((door_candidates & 4) == 4) apply_door_candidate(0, 0, 0, 1);
@@ -631,13 +643,13 @@ void Room::generate_type_a()
         int x1, y1, x2, y2;
         do
         {
-            x1 = Random::rng(width_ - 2);
-            x2 = Random::rng(width_ - 2);
+            x1 = dungeon_gen_->rng(width_ - 2);
+            x2 = dungeon_gen_->rng(width_ - 2);
         } while (std::abs(x1 - x2) <= 2);
         do
         {
-            y1 = Random::rng(height_ - 2);
-            y2 = Random::rng(height_ - 2);
+            y1 = dungeon_gen_->rng(height_ - 2);
+            y2 = dungeon_gen_->rng(height_ - 2);
         } while (std::abs(y1 - y2) <= 2);
         dig(x1, y1, x2, y2);
     }
@@ -4,10 +4,13 @@
 #ifndef AREA_GEN_DUNGEON_HPP_
 #define AREA_GEN_DUNGEON_HPP_
 
+#include <cstdint>
 #include <memory>
 #include <tuple>
 #include <vector>
 
+#include "util/random.hpp"
+
 
 namespace invictus
 {
@@ -22,7 +25,7 @@ class Tile; // defined in area/tile.hpp
 class DungeonGenerator
 {
 public:
-            DungeonGenerator(std::shared_ptr<Area> area_to_gen);    // Prepares an Area for procedural generation.
+            DungeonGenerator(std::shared_ptr<Area> area_to_gen, uint32_t seed); // Prepares an Area for procedural generation, with a given random seed.
     void    generate(); // Generates the new map!
 
 private:
@@ -32,11 +35,14 @@ private:
     void    get_internal_room_size(unsigned int room_id, int *x, int *y, int *w, int *h);   // Gets the internal coordinates of a room, not counting doors.
     int     neighbours(int x, int y, TileID type, bool diagonals = true, int range = 1);    // Checks how many neighbouring tiles are the specified type.
     bool    paste_room(std::shared_ptr<Room> room, int x, int y);   // Attempts to paste a room at the given coordinates.
+    unsigned int    rng(unsigned int min, unsigned int max);    // Generates a random number between, and including, the two specified values.
+    unsigned int    rng(unsigned int max);  // As above, but with an implied minimum number of 1.
     void    void_map(); // Voids (empties) this entire map.
 
     int         active_room_;       // The current room being modified.
     std::shared_ptr<Area>   area_;  // The Area being created by this dungeon generator.
     bool        first_room_;        // The first room requires no links, obviously.
+    Xoshiro256  rng_;       // This generator's own random number engine, so the same seed always produces the same map, on any thread.
     std::vector<std::tuple<int, int, int, int>> rooms_; // The X,Y coordinates, width and height of each room.
     int         stairs_up_room_;    // Which room are the upward stairs located in?
 
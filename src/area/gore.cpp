@@ -31,7 +31,7 @@ void Gore::do_splash(int x, int y)
     int new_gore_level = current_gore + 1;
     if (new_gore_level >= 7)
     {
-        int roll = Random::rng(10);
+        int roll = Random::rng(10, RNG::GORE);
         if (roll <= 5) new_gore_level = 6;
         else if (roll <= 8) new_gore_level = 5;
         else if (roll == 9) new_gore_level = 4;
@@ -39,10 +39,10 @@ void Gore::do_splash(int x, int y)
     }
     set_gore(x, y, new_gore_level);
 
-    if (Random::rng(100) <= spread_chance)
+    if (Random::rng(100, RNG::GORE) <= spread_chance)
     {
-        int dx = (Random::rng(2) == 1 ? -1 : 1);
-        int dy = static_cast<int>(Random::rng(3)) - 2;
+        int dx = (Random::rng(2, RNG::GORE) == 1 ? -1 : 1);
+        int dy = static_cast<int>(Random::rng(3, RNG::GORE)) - 2;
         if (dx < 0 || dy < 0 || dx >= area->width() || dy >= area->height()) return;
         Tile* new_tile = area->tile(x + dx, y + dy);
         if (tile->tag(TileTag::BlocksMovement) && new_tile->tag(TileTag::BlocksMovement)) return;
@@ -95,13 +95,13 @@ void Gore::set_gore(int x, int y, int level)
 // Splashes blood and gore on a given tile.
 void Gore::splash(int x, int y, int intensity)
 {
-    if (intensity < 5 && Random::rng(3) == 1) intensity += Random::rng(3);  // Below level 5, there's a 1 in 3 chance to escalate by 1-3 levels.
-    else if (intensity < 10) intensity += Random::rng(0, 5);    // From levels 5-9, escalate between 0-5 levels.
-    else intensity += Random::rng(0, 10);   // At level 10+, escalate from 0-10 levels.
+    if (intensity < 5 && Random::rng(3, RNG::GORE) == 1) intensity += Random::rng(3, RNG::GORE);   // Below level 5, there's a 1 in 3 chance to escalate by 1-3 levels.
+    else if (intensity < 10) intensity += Random::rng(0, 5, RNG::GORE);    // From levels 5-9, escalate between 0-5 levels.
+    else intensity += Random::rng(0, 10, RNG::GORE);   // At level 10+, escalate from 0-10 levels.
 
     for (int i = 0; i < intensity; i++)
         do_splash(x, y);
-    core()->game()->area()->need_fov_recalc();
+    core()->game()->area()->need_fov_recalc(FovChange::COSMETIC);
     core()->game()->ui()->redraw_dungeon();
     core()->game()->ui()->redraw_nearby();
 }
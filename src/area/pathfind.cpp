@@ -1,11 +1,12 @@
-// area/pathfind.cpp -- Fairly simple implementation of A* pathfinding, with Manhattan/Euclidean methods.
+// area/pathfind.cpp -- Heap-based A* pathfinding on a flat grid, with Manhattan/Euclidean methods.
 // Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
 
+#include <algorithm>
 #include <cmath>
 
 #include "area/area.hpp"
+#include "area/bitplane.hpp"
 #include "area/pathfind.hpp"
-#include "area/tile.hpp"
 #include "core/core.hpp"
 #include "core/game-manager.hpp"
 #include "core/guru.hpp"
@@ -17,33 +18,28 @@
 namespace invictus
 {
 
-/******************************
- * ASTARTILE CLASS DEFINITION *
- ******************************/
+/*********************************
+ * PATHFINDGRID CLASS DEFINITION *
+ *********************************/
 
-// Constructor.
-AStarTile::AStarTile(int start_x, int start_y, int end_x, int end_y, float tile_cost) : end_x_(end_x), end_y_(end_y), start_x_(start_x), start_y_(start_y),
-    tile_cost_(tile_cost)
+// Constructor, sets up the grid for an Area of the given size.
+PathfindGrid::PathfindGrid(int width, int height) : closed_stamp_(width * height, 0), g_cost_(width * height, 0), generation_(0),
+    open_stamp_(width * height, 0), parent_(width * height, 0) { }
+
+// Starts a new search, and returns its generation stamp.
+uint32_t PathfindGrid::new_search()
 {
-    if (core()->prefs()->pathfind_euclidean()) heuristic_ = std::sqrt(std::pow(std::abs(start_x_ - end_x_), 2) + std::pow(std::abs(start_y_ - end_y_), 2));
-    else heuristic_ = std::abs(start_x_ - end_x_) + std::abs(start_y_ - end_y_);
+    // On the off chance that the generation counter wraps around, old stamps could be mistaken for new ones, so we'll wipe them all.
+    if (++generation_ == 0)
+    {
+        std::fill(closed_stamp_.begin(), closed_stamp_.end(), 0);
+        std::fill(open_stamp_.begin(), open_stamp_.end(), 0);
+        generation_ = 1;
+    }
+    open_list_.clear();
+    return generation_;
 }
 
-// Sets the tile cost (g) for this tile.
-void AStarTile::set_tile_cost(int cost) { tile_cost_ = cost; }
-
-// Retrieves the start_x coord.
-int AStarTile::start_x() const { return start_x_; }
-
-// Retrieves the start_y coord.
-int AStarTile::start_y() const { return start_y_; }
-
-// Retrieves the tile cost of this tile (g).
-float AStarTile::tile_cost() const { return tile_cost_; }
-
-// Gets the total cost of this tile (g + h).
-float AStarTile::total_cost() const { return tile_cost_ + heuristic_; }
-
 
 /*****************************
  * PATHFIND CLASS DEFINITION *
@@ -56,196 +52,131 @@ Pathfind::Pathfind(PathfindMode mode, int start_x, int start_y, int end_x, int e
 // A* pathfinding algorithm.
 std::vector<std::pair<int, int>> Pathfind::pathfind()
 {
-    std::vector<std::shared_ptr<AStarTile>> checked_tiles;  // A list of tiles that have already been checked.
-    std::vector<std::shared_ptr<AStarTile>> viable_tiles;   // The current tiles that are still viable options.
+    std::vector<std::pair<int, int>> path;
     auto area = core()->game()->area();
     auto guru = core()->guru();
+    const int width = area->width(), height = area->height();
     if (LOG_PATHFINDING) guru->log("Attempting to pathfind from " + std::to_string(start_x_) + "," + std::to_string(start_y_) + " to " +
         std::to_string(end_x_) + "," + std::to_string(end_y_));
+    if (start_x_ < 0 || start_y_ < 0 || start_x_ >= width || start_y_ >= height || end_x_ < 0 || end_y_ < 0 || end_x_ >= width || end_y_ >= height)
+    {
+        if (LOG_PATHFINDING) guru->log("Start or end coordinates are out of bounds!");
+        return path;
+    }
+    if (start_x_ == end_x_ && start_y_ == end_y_) return path;
+
+    PathfindGrid* grid = area->pathfind_grid();
+    const Bitplane* impassable = area->impassable_plane();
+    const uint32_t stamp = grid->new_search();
+    const bool euclidean = core()->prefs()->pathfind_euclidean();
+    const uint32_t start_index = start_x_ + (start_y_ * width), end_index = end_x_ + (end_y_ * width);
+
+    auto heuristic = [this, euclidean](int x, int y) -> float
+    {
+        const int dx = std::abs(x - end_x_), dy = std::abs(y - end_y_);
+        if (euclidean) return std::sqrt(static_cast<float>((dx * dx) + (dy * dy)));
+        else return dx + dy;
+    };
+
+    // The open list is a binary min-heap, ordered by total cost, with ties going to whichever node is closest to the destination.
+    auto heap_order = [](const PathfindNode &a, const PathfindNode &b) -> bool
+    {
+        if (a.total_cost != b.total_cost) return a.total_cost > b.total_cost;
+        return a.heuristic > b.heuristic;
+    };
 
     // Add the starting tile to the list.
-    checked_tiles.push_back(std::make_shared<AStarTile>(start_x_, start_y_, end_x_, end_y_, 0));
+    grid->open_stamp_.at(start_index) = stamp;
+    grid->g_cost_.at(start_index) = 0;
+    grid->parent_.at(start_index) = start_index;
+    const float start_heuristic = heuristic(start_x_, start_y_);
+    grid->open_list_.push_back({start_heuristic, start_heuristic, start_index});
 
-    auto find_candidates = [this, &area, &checked_tiles, &guru, &viable_tiles](std::shared_ptr<AStarTile> current_tile = nullptr) -> int
+    // Loop until we run out of viable tiles to check.
+    bool found_destination = false;
+    int tries = 0;
+    while (grid->open_list_.size() && tries < PATHFIND_MAX_TRIES)
     {
-        int new_candidates = 0;
-        float travel_cost = 0, current_cost = 0;
-        int current_x = start_x_, current_y = start_y_;
-        if (current_tile)
+        std::pop_heap(grid->open_list_.begin(), grid->open_list_.end(), heap_order);
+        const PathfindNode current = grid->open_list_.back();
+        grid->open_list_.pop_back();
+
+        // Nodes aren't removed from the heap when a cheaper route is found, so just skip over any stale entries.
+        if (grid->closed_stamp_.at(current.index) == stamp) continue;
+        grid->closed_stamp_.at(current.index) = stamp;
+        tries++;
+
+        if (current.index == end_index)
         {
-            current_cost = current_tile->tile_cost();
-            current_x = current_tile->start_x();
-            current_y = current_tile->start_y();
+            found_destination = true;
+            break;
         }
 
+        const int current_x = current.index % width, current_y = current.index / width;
+        const float current_cost = grid->g_cost_.at(current.index);
+        if (LOG_PATHFINDING) guru->log(std::to_string(grid->open_list_.size()) + " tiles remain. Checking " + std::to_string(current_x) + "," +
+            std::to_string(current_y) + " (score: " + std::to_string(current.total_cost) + ")");
+
         for (int x = -1; x <= 1; x++)
         {
             for (int y = -1; y <= 1; y++)
             {
                 if (x == 0 && y == 0) continue;
-                travel_cost = ((x == 0 || y == 0) ? PATHFIND_TRAVEL_COST_STRAIGHT : PATHFIND_TRAVEL_COST_DIAGONAL);
-
-                // Check if the tile we're investigating is already on the list.
-                if (current_tile)
+                const int coord_x = current_x + x, coord_y = current_y + y;
+                if (coord_x < 0 || coord_y < 0 || coord_x >= width || coord_y >= height) continue;
+                const uint32_t index = coord_x + (coord_y * width);
+                if (grid->closed_stamp_.at(index) == stamp) continue;
+                if (impassable->get(coord_x, coord_y))
                 {
-                    bool valid = true;
-                    int check_x = current_tile->start_x() + x, check_y = current_tile->start_y() + y;
-                    for (auto tile : checked_tiles)
-                    {
-                        if (tile->start_x() == check_x && tile->start_y() == check_y)
-                        {
-                            valid = false;
-                            break;
-                        }
-                    }
-                    if (!valid) continue;
+                    grid->closed_stamp_.at(index) = stamp;
+                    continue;
                 }
 
-                // Add this tile to the potentials list.
-                int coord_x = current_x + x, coord_y = current_y + y;
-                auto possible_tile = std::make_shared<AStarTile>(coord_x, coord_y, end_x_, end_y_, current_cost + travel_cost);
-
-                checked_tiles.push_back(possible_tile);
-                const bool blocks_movement = area->tile(coord_x, coord_y)->tag(TileTag::BlocksMovement);
-                bool add_to_viable = true;
-                if (blocks_movement)
+                // Check for anything in the way. In monster mode, the player doesn't count, and other Monsters just make the route more costly.
+                // The player isn't part of the Area's spatial index, which works out nicely, as in player mode they're always the one pathfinding.
+                float travel_cost = current_cost + ((x == 0 || y == 0) ? PATHFIND_TRAVEL_COST_STRAIGHT : PATHFIND_TRAVEL_COST_DIAGONAL);
+                bool impassable = false;
+                for (auto &entity : area->entities_at(coord_x, coord_y))
                 {
-                    possible_tile->set_tile_cost(BIG_NUMBER);
-                    if (LOG_PATHFINDING) guru->log("Marking invalid tile: " + std::to_string(coord_x) + "," + std::to_string(coord_y));
-                    continue;
+                    if (!entity->blocks_tile(coord_x, coord_y)) continue;
+                    if (mode_ == PathfindMode::PATHFIND_MONSTER && entity->type() == EntityType::MONSTER) travel_cost += PATHFIND_ALLY_BLOCKER_COST;
+                    else impassable = true;
+                    break;
                 }
-                for (auto entity : *area->entities())
+                if (impassable)
                 {
-                    if (entity->blocks_tile(coord_x, coord_y))
-                    {
-                        if (mode_ == PathfindMode::PATHFIND_MONSTER && entity->type() == EntityType::PLAYER) continue;
-                        if (mode_ == PathfindMode::PATHFIND_MONSTER && entity->type() == EntityType::MONSTER)
-                        {
-                            possible_tile->set_tile_cost(current_cost + travel_cost + PATHFIND_ALLY_BLOCKER_COST);
-                            continue;
-                        }
-                        possible_tile->set_tile_cost(BIG_NUMBER);
-                        add_to_viable = false;
-                        break;
-                    }
+                    grid->closed_stamp_.at(index) = stamp;
+                    continue;
                 }
-                if (!add_to_viable) continue;
-                if (LOG_PATHFINDING) guru->log("Marking potential tile: " + std::to_string(coord_x) + "," + std::to_string(coord_y));
-                viable_tiles.push_back(possible_tile);
-                new_candidates++;
-            }
-        }
-        
-        return new_candidates;
-    };
 
-    // Add the initial up/down/left/right positions to the lists.
-    int new_candidates = find_candidates();
-    if (LOG_PATHFINDING) guru->log(std::to_string(new_candidates) + " initial candidates.");
-
-    // Loop until we run out of viable tiles to check.
-    bool found_destination = false;
-    int tries = 0;
-    std::shared_ptr<AStarTile> current_tile = nullptr;
-    while (viable_tiles.size() > 0 && tries++ < PATHFIND_MAX_TRIES)
-    {
-        // Attempt to find the best possible option.
-        float lowest_score = BIG_NUMBER;
-        for (auto tile : viable_tiles)
-        {
-            if (tile->start_x() == end_x_ && tile->start_y() == end_y_)
-            {
-                current_tile = tile;
-                found_destination = true;
-                break;
-            }
-            else if (tile->total_cost() < lowest_score)
-            {
-                current_tile = tile;
-                lowest_score = tile->total_cost();
+                // Only bother adding this tile to the open list if it's new, or if this route to it is cheaper than the last one.
+                if (grid->open_stamp_.at(index) == stamp && grid->g_cost_.at(index) <= travel_cost) continue;
+                grid->open_stamp_.at(index) = stamp;
+                grid->g_cost_.at(index) = travel_cost;
+                grid->parent_.at(index) = current.index;
+                const float tile_heuristic = heuristic(coord_x, coord_y);
+                grid->open_list_.push_back({travel_cost + tile_heuristic, tile_heuristic, index});
+                std::push_heap(grid->open_list_.begin(), grid->open_list_.end(), heap_order);
             }
         }
-        if (found_destination || lowest_score == BIG_NUMBER) break;
-
-        for (unsigned int i = 0; i < viable_tiles.size(); i++)
-        {
-            if (viable_tiles.at(i) == current_tile)
-            {
-                viable_tiles.erase(viable_tiles.begin() + i);
-                break;
-            }
-        }
-        
-        if (LOG_PATHFINDING) guru->log(std::to_string(viable_tiles.size()) + " tiles remain. Checking " + std::to_string(current_tile->start_x())  + "," +
-            std::to_string(current_tile->start_y()) + " (score: " + std::to_string(current_tile->total_cost()) + ")");
-        new_candidates = find_candidates(current_tile);
-        if (LOG_PATHFINDING) guru->log(std::to_string(new_candidates) + " new candidates.");
     }
 
-    std::vector<std::pair<int, int>> path;
-    if (tries >= PATHFIND_MAX_TRIES)
+    if (!found_destination)
     {
-        if (LOG_PATHFINDING) guru->log("Could not find destination, aborting after " + std::to_string(PATHFIND_MAX_TRIES) + "+ tries.");
-        return path;
-    }
-
-    if (found_destination)
-    {
-        if (LOG_PATHFINDING) guru->log("Found destination! Total travel score: " + std::to_string(current_tile->total_cost()));
-        int current_x = end_x_, current_y = end_y_;
-        path.push_back(std::pair<int, int>(end_x_, end_y_));
-        tries = 0;
-        int best_score = BIG_NUMBER;
-        while ((current_x != start_x_ || current_y != start_y_) && tries++ < PATHFIND_MAX_TRIES)
-        {
-            std::shared_ptr<AStarTile> best_option = nullptr;
-            for (int x = -1; x <= 1; x++)
-            {
-                for (int y = -1; y <= 1; y++)
-                {
-                    if (x == 0 && y == 0) continue;
-                    int here_x = current_x + x, here_y = current_y + y;
-                    for (auto tile : checked_tiles)
-                    {
-                        if (tile->start_x() != here_x || tile->start_y() != here_y) continue;
-                        else if (tile->tile_cost() < best_score)
-                        {
-                            best_score = tile->tile_cost();
-                            best_option = tile;
-                        }
-                        break;
-                    }
-                }
-            }
-            if (!best_option)
-            {
-                if (LOG_PATHFINDING) guru->log("Could not determine next tile in backwalk!");
-                path.clear();
-                return path;
-            }
-            current_x = best_option->start_x();
-            current_y = best_option->start_y();
-            if (current_x != start_x_ || current_y != start_y_) path.insert(path.begin(), std::pair<int, int>(current_x, current_y));
-        }
         if (LOG_PATHFINDING)
         {
-            if (tries >= 1000)
-            {
-                guru->log("Unable to complete path backwalk. Length so far: " + std::to_string(path.size()) + ". Tiles checked: " +
-                    std::to_string(checked_tiles.size()) + ".");
-                guru->log("Start: " + std::to_string(start_x_) + "," + std::to_string(start_y_) + ". End: " + std::to_string(end_x_) + "," +
-                    std::to_string(end_y_));
-            }
-            else guru->log("Path walked backwards, total length: " + std::to_string(path.size()) + ". Tiles checked: " + std::to_string(checked_tiles.size()) +
-                ".");
-        }
-        if (tries >= 1000)
-        {
-            path.clear();
-            return path;
+            if (tries >= PATHFIND_MAX_TRIES) guru->log("Could not find destination, aborting after " + std::to_string(PATHFIND_MAX_TRIES) + "+ tries.");
+            else guru->log("Could not find destination. :(");
         }
+        return path;
     }
-    else if (LOG_PATHFINDING) guru->log("Could not find destination. :(");
+
+    // Follow the parent indices back to the start, then flip the path around. The starting tile itself is not included.
+    if (LOG_PATHFINDING) guru->log("Found destination! Total travel score: " + std::to_string(grid->g_cost_.at(end_index)));
+    for (uint32_t index = end_index; index != start_index; index = grid->parent_.at(index))
+        path.push_back(std::pair<int, int>(index % width, index / width));
+    std::reverse(path.begin(), path.end());
+    if (LOG_PATHFINDING) guru->log("Path walked backwards, total length: " + std::to_string(path.size()) + ". Tiles checked: " + std::to_string(tries) + ".");
     return path;
 }
 
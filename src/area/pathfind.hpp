@@ -1,4 +1,4 @@
-// area/pathfind.hpp -- Fairly simple implementation of A* pathfinding, with Manhattan/Euclidean methods.
+// area/pathfind.hpp -- Heap-based A* pathfinding on a flat grid, with Manhattan/Euclidean methods.
 // Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
 
 #ifndef AREA_PATHFIND_HPP_
@@ -15,22 +15,32 @@ namespace invictus
 enum class PathfindMode : uint8_t { PATHFIND_PLAYER, PATHFIND_MONSTER };
 
 
-// Data struct used with A* pathfinding calculations.
-class AStarTile
+// An entry on the A* open list.
+struct PathfindNode
+{
+    float       total_cost; // The total cost of this node (g + h).
+    float       heuristic;  // The estimated (heuristic) cost from this node to the destination (h), used to break ties.
+    uint32_t    index;      // The grid index of this node.
+};
+
+
+// Flat scratch memory for A* searches, owned by an Area and reused across calls so pathfinding doesn't need to allocate per node.
+class PathfindGrid
 {
 public:
-            AStarTile(int start_x, int start_y, int end_x, int end_y, float tile_cost);// Constructor.
-    void    set_tile_cost(int cost);    // Sets the tile cost (g) for this tile.
-    int     start_x() const;    // Retrieves the start_x coord.
-    int     start_y() const;    // Retrieves the start_y coord.
-    float   tile_cost() const;  // Retrieves the tile cost of this tile (g).
-    float   total_cost() const; // Gets the total cost of this tile (g + h).
+                PathfindGrid(int width, int height);    // Constructor, sets up the grid for an Area of the given size.
 
 private:
-    int     end_x_, end_y_;     // Coordinates of the destination tile.
-    float   heuristic_;         // The estimated (heuristic) cost of this tile (h).
-    int     start_x_, start_y_; // Coordinates of the starting tile.
-    float   tile_cost_;         // The cost so far to travel through this tile (g).
+    uint32_t    new_search();   // Starts a new search, and returns its generation stamp.
+
+    std::vector<uint32_t>       closed_stamp_;  // The generation stamp of the search in which each tile was closed.
+    std::vector<float>          g_cost_;        // The cost so far to travel to each tile (g).
+    uint32_t                    generation_;    // The current search generation. Tiles stamped with an older generation are treated as untouched.
+    std::vector<PathfindNode>   open_list_;     // The A* open list, kept as a binary heap.
+    std::vector<uint32_t>       open_stamp_;    // The generation stamp of the search in which each tile's g_cost_ and parent_ were written.
+    std::vector<uint32_t>       parent_;        // The grid index each tile was reached from.
+
+friend class Pathfind;
 };
 
 
@@ -42,8 +52,6 @@ public:
     std::vector<std::pair<int, int>>    pathfind(); // A* pathfinding algorithm.
 
 private:
-    static constexpr int    BIG_NUMBER = 999999999; // A really big number.
-
     int             end_x_, end_y_;     // The ending X,Y coordinates.
     PathfindMode    mode_;              // The pathfinding mode in use.
     int             start_x_, start_y_; // The starting X,Y coordinates.
@@ -1,77 +1,106 @@
 // area/shadowcast.cpp -- Shadowcasting code, for calculating line-of-sight.
-// Based on original code from here: https://www.roguebasin.com/index.php/C%2B%2B_shadowcasting_implementation
-// Modified slightly by Raine "Gravecat" Simmons, 2023.
+// Originally based on code from here: https://www.roguebasin.com/index.php/C%2B%2B_shadowcasting_implementation
+// Rewritten to use exact integer slopes and an explicit stack by Raine "Gravecat" Simmons, 2023.
 
-#include <cmath>
+#include <algorithm>
 
-#include "area/area.hpp"
+#include "area/bitplane.hpp"
 #include "area/shadowcast.hpp"
 
 
 namespace invictus
 {
 
-int Shadowcast::multipliers[4][8] = {
+const int Shadowcast::multipliers_[4][8] = {
     {1, 0, 0, -1, -1, 0, 0, 1},
     {0, 1, -1, 0, 0, -1, 1, 0},
     {0, 1, 1, 0, 0, -1, -1, 0},
     {1, 0, 0, 1, -1, 0, 0, -1}
 };
+std::vector<std::vector<int>> Shadowcast::row_limits_;  // Precomputed tables of visible columns on each row, indexed by radius.
+std::vector<Shadowcast::Span> Shadowcast::stack_;       // Spans waiting to be scanned. Kept between calls so it doesn't need reallocating.
 
-void Shadowcast::calc_fov(Area* area, unsigned int x, unsigned int y, unsigned int radius)
+// Marks every tile visible from the given origin.
+void Shadowcast::calc_fov(const Bitplane* opacity, bool* visible, int x, int y, int radius)
 {
-    for (unsigned int i = 0; i < 8; i++)
-        cast_light(area, x, y, radius, 1, 1.0, 0.0, multipliers[0][i], multipliers[1][i], multipliers[2][i], multipliers[3][i]);
-}
-
-void Shadowcast::cast_light(Area* area, unsigned int x, unsigned int y, unsigned int radius, unsigned int row, float start_slope, float end_slope,
-    unsigned int xx, unsigned int xy, unsigned int yx, unsigned int yy)
-{
-    if (start_slope < end_slope) return;
-    float next_start_slope = start_slope;
+    const int width = opacity->width(), height = opacity->height();
+    if (x < 0 || y < 0 || x >= width || y >= height || radius <= 0) return;
+    const std::vector<int> &limits = row_limits(radius);
 
-    for (unsigned int i = row; i <= radius; i++)
+    for (int octant = 0; octant < 8; octant++)
     {
-        bool blocked = false;
-        for (int dx = -i, dy = -i; dx <= 0; dx++)
-        {
-            float l_slope = (dx - 0.5) / (dy + 0.5);
-            float r_slope = (dx + 0.5) / (dy - 0.5);
-            if (start_slope < r_slope) continue;
-            else if (end_slope > l_slope) break;
-
-            int sax = dx * xx + dy * xy;
-            int say = dx * yx + dy * yy;
-            if ((sax < 0 && static_cast<unsigned int>(std::abs(sax)) > x) || (say < 0 && static_cast<unsigned int>(std::abs(say)) > y)) continue;
-            unsigned int ax = x + sax;
-            unsigned int ay = y + say;
-            if (ax >= static_cast<unsigned int>(area->width()) || ay >= static_cast<unsigned int>(area->height())) continue;
+        const int xx = multipliers_[0][octant], xy = multipliers_[1][octant], yx = multipliers_[2][octant], yy = multipliers_[3][octant];
+        stack_.clear();
+        stack_.push_back({1, 1, 1, 0, 1});
 
-            unsigned int radius2 = radius * radius;
-            if (static_cast<unsigned int>(dx * dx + dy * dy) < radius2) area->set_visible(ax, ay);
+        while (stack_.size())
+        {
+            Span span = stack_.back();
+            stack_.pop_back();
+            if (span.start_num * span.end_den < span.end_num * span.start_den) continue;
+            int next_start_num = span.start_num, next_start_den = span.start_den;
 
-            if (blocked)
+            for (int row = span.row; row <= radius; row++)
             {
-                if (area->is_opaque(ax, ay))
-                {
-                    next_start_slope = r_slope;
-                    continue;
-                }
-                else
+                // Each cell on a row covers the slopes from (2 * col - 1) / (2 * row + 1) to (2 * col + 1) / (2 * row - 1). Rather than testing every cell
+                // against the start of the span, the first one that overlaps it can be worked out directly.
+                const int col_first = std::min(row, ((span.start_num * ((2 * row) + 1)) + span.start_den) / (2 * span.start_den));
+                bool blocked = false;
+                for (int col = col_first; col >= 0; col--)
                 {
-                    blocked = false;
-                    start_slope = next_start_slope;
+                    const int l_num = (2 * col) + 1, l_den = (2 * row) - 1;
+                    if (span.end_num * l_den > l_num * span.end_den) break;
+                    const int r_num = (2 * col) - 1, r_den = (2 * row) + 1;
+
+                    const int ax = x - (col * xx) - (row * xy), ay = y - (col * yx) - (row * yy);
+                    if (ax < 0 || ay < 0 || ax >= width || ay >= height) continue;
+                    if (col <= limits[row]) visible[ax + (ay * width)] = true;
+
+                    const bool opaque = opacity->get(ax, ay);
+                    if (blocked)
+                    {
+                        if (opaque)
+                        {
+                            next_start_num = r_num;
+                            next_start_den = r_den;
+                        }
+                        else
+                        {
+                            blocked = false;
+                            span.start_num = next_start_num;
+                            span.start_den = next_start_den;
+                        }
+                    }
+                    else if (opaque)
+                    {
+                        blocked = true;
+                        next_start_num = r_num;
+                        next_start_den = r_den;
+                        stack_.push_back({row + 1, span.start_num, span.start_den, l_num, l_den});
+                    }
                 }
-            }
-            else if (area->is_opaque(ax, ay))
-            {
-                blocked = true;
-                next_start_slope = r_slope;
-                cast_light(area, x, y, radius, i + 1, start_slope, l_slope, xx, xy, yx, yy);
+                if (blocked) break;
             }
         }
-        if (blocked) break;
     }
 }
 
+// Retrieves the table of visible columns on each row, for a given radius.
+const std::vector<int>& Shadowcast::row_limits(int radius)
+{
+    if (static_cast<int>(row_limits_.size()) <= radius) row_limits_.resize(radius + 1);
+    std::vector<int> &limits = row_limits_.at(radius);
+    if (limits.size()) return limits;
+
+    // A cell is within the radius if col^2 + row^2 < radius^2. The highest column satisfying this is stored for each row, or -1 if there are none.
+    limits.resize(radius + 1);
+    for (int row = 0; row <= radius; row++)
+    {
+        int col = row;
+        while (col >= 0 && (col * col) + (row * row) >= radius * radius) col--;
+        limits.at(row) = col;
+    }
+    return limits;
+}
+
 }   // namespace invictus
@@ -1,26 +1,38 @@
 // area/shadowcast.hpp -- Shadowcasting code, for calculating line-of-sight.
-// Based on original code from here: https://www.roguebasin.com/index.php/C%2B%2B_shadowcasting_implementation
-// Modified slightly by Raine "Gravecat" Simmons, 2023.
+// Originally based on code from here: https://www.roguebasin.com/index.php/C%2B%2B_shadowcasting_implementation
+// Rewritten to use exact integer slopes and an explicit stack by Raine "Gravecat" Simmons, 2023.
 
 #ifndef AREA_SHADOW_CAST_HPP_
 #define AREA_SHADOW_CAST_HPP_
 
+#include <vector>
+
+
 namespace invictus
 {
 
-class Area; // defined in area/area.hpp
+class Bitplane; // defined in area/bitplane.hpp
 
 
 class Shadowcast
 {
 public:
-    static void calc_fov(Area* area, unsigned int x, unsigned int y, unsigned int radius);
+    static void calc_fov(const Bitplane* opacity, bool* visible, int x, int y, int radius);  // Marks every tile visible from the given origin.
 
 private:
-    static void cast_light(Area* area, unsigned int x, unsigned int y, unsigned int radius, unsigned int row, float start_slope, float end_slope,
-        unsigned int xx, unsigned int xy, unsigned int yx, unsigned int yy);
-
-    static int  multipliers[4][8];
+    // A section of an octant still waiting to be scanned. Slopes are stored as exact fractions (numerator / denominator), with positive denominators.
+    struct Span
+    {
+        int row;                    // The first row (distance from the origin) to scan.
+        int start_num, start_den;   // The starting (steepest) slope of the span.
+        int end_num, end_den;       // The ending (shallowest) slope of the span.
+    };
+
+    static const std::vector<int>&  row_limits(int radius); // Retrieves the table of visible columns on each row, for a given radius.
+
+    static const int                multipliers_[4][8];     // Transforms octant coordinates into map coordinates, for each of the eight octants.
+    static std::vector<std::vector<int>>    row_limits_;    // Precomputed tables of visible columns on each row, indexed by radius.
+    static std::vector<Span>        stack_;                 // Spans waiting to be scanned. Kept between calls so it doesn't need reallocating.
 };
 
 }       // namespace invictus
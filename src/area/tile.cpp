@@ -3,8 +3,11 @@
 
 #include <vector>
 
+#include "area/area.hpp"
 #include "area/tile.hpp"
 #include "codex/codex-tile.hpp"
+#include "core/core.hpp"
+#include "core/guru.hpp"
 #include "terminal/terminal-shared-defs.hpp"
 #include "tune/ascii-symbols.hpp"
 #include "util/strx.hpp"
@@ -13,35 +16,47 @@
 namespace invictus
 {
 
+std::vector<std::string> Tile::custom_names_(1);    // Non-stock Tile names, shared between all Tiles. Index 0 is unused, meaning the stock name.
+
 // Constructor.
-Tile::Tile() : ascii_(ASCII_NOTHING), ascii_scars_(ASCII_NOTHING), colour_(Colour::WHITE), colour_scars_(Colour::WHITE), id_(TileID::VOID_TILE), name_("tile")
-{ }
+Tile::Tile() : ascii_(ASCII_NOTHING), ascii_scars_(ASCII_NOTHING), colour_(Colour::WHITE), colour_scars_(Colour::WHITE), id_(TileID::VOID_TILE), name_(0),
+    tags_(0) { }
 
 // Get the ASCII character for this Tile.
 char Tile::ascii(bool ignore_scars) const
 {
-    if (ignore_scars) return ascii_;
-    else if (tag(TileTag::Bloodied)) return ascii_scars_;
-    else return ascii_;
+    if (!ignore_scars && tag(TileTag::Bloodied)) return ascii_scars_;
+    else if (tag(TileTag::Changed)) return ascii_;
+    else return CodexTile::prototype(id_).ascii;
 }
 
 // Clears a TileTag from this Tile.
 void Tile::clear_tag(TileTag the_tag, bool changed)
 {
-    if (!(tags_.count(the_tag) > 0)) return;
-    tags_.erase(the_tag);
+    if (!tag(the_tag)) return;
+    const uint32_t old_tags = tags_;
+    tags_ &= ~tag_bit(the_tag);
+    planes_changed(old_tags);
     if (changed && the_tag != TileTag::Changed) set_tag(TileTag::Changed);
 }
 
 // Clears multiple TileTags from this Tile.
-void Tile::clear_tags(std::initializer_list<TileTag> tag_list, bool changed) { for (auto &the_tag : tag_list) clear_tag(the_tag, changed); }
+void Tile::clear_tags(std::initializer_list<TileTag> tag_list, bool changed)
+{
+    const uint32_t bits = tag_bits(tag_list);
+    if (!(tags_ & bits)) return;
+    const uint32_t old_tags = tags_;
+    tags_ &= ~bits;
+    if (changed) tags_ |= tag_bit(TileTag::Changed);
+    planes_changed(old_tags);
+}
 
 // Gets the colour of this Tile.
 Colour Tile::colour(bool ignore_scars) const
 {
-    if (ignore_scars) return colour_;
-    else if (tag(TileTag::Bloodied)) return colour_scars_;
-    else return colour_;
+    if (!ignore_scars && tag(TileTag::Bloodied)) return colour_scars_;
+    else if (tag(TileTag::Changed)) return colour_;
+    else return CodexTile::prototype(id_).colour;
 }
 
 // Retrieves the ID of this Tile.
@@ -50,26 +65,26 @@ TileID Tile::id() const { return id_; }
 // Checks if this Tile is identical to another.
 bool Tile::is_identical_to(Tile* tile)
 {
-    if (id_ != tile->id_ || ascii_ != tile->ascii_ || colour_ != tile->colour_ || ascii_scars_ != tile->ascii_scars_ || colour_scars_ != tile->colour_scars_ ||
-        name_.compare(tile->name_)) return false;
-    for (auto the_tag : tags_)
-        if (!tile->tag(the_tag)) return false;
-    for (auto the_tag : tile->tags_)
-        if (!tag(the_tag)) return false;
-    return true;
+    return (id_ == tile->id_ && tags_ == tile->tags_ && ascii_ == tile->ascii_ && colour_ == tile->colour_ && ascii_scars_ == tile->ascii_scars_ &&
+        colour_scars_ == tile->colour_scars_ && name_ == tile->name_);
 }
 
 // Gets the name of this Tile.
 std::string Tile::name(bool with_suffixes) const
 {
-    if (!with_suffixes) return name_;
+    const std::string &base_name = ((name_ && tag(TileTag::Changed)) ? custom_names_.at(name_) : CodexTile::prototype(id_).name);
+    if (!with_suffixes) return base_name;
     std::vector<std::string> suffixes;
     if (tag(TileTag::Bloodied)) suffixes.push_back("bloodied");
     if (tag(TileTag::Open)) suffixes.push_back("open");
-    if (suffixes.size()) return name_ + " (" + StrX::comma_list(suffixes) + ")";
-    else return name_;
+    if (suffixes.size()) return base_name + " (" + StrX::comma_list(suffixes) + ")";
+    else return base_name;
 }
 
+// Lets the Area owning this Tile know if its light or movement blocking has changed.
+void Tile::planes_changed(uint32_t old_tags) const
+{ if ((old_tags ^ tags_) & (tag_bit(TileTag::BlocksLight) | tag_bit(TileTag::BlocksMovement))) Area::tile_planes_changed(this); }
+
 // Sets this Tile's ASCII character.
 void Tile::set_ascii(char new_ascii)
 {
@@ -87,8 +102,23 @@ void Tile::set_colour(Colour new_colour)
 // Sets this Tile's name.
 void Tile::set_name(const std::string &new_name)
 {
-    name_ = new_name;
     set_tag(TileTag::Changed);
+    if (!new_name.compare(CodexTile::prototype(id_).name))
+    {
+        name_ = 0;
+        return;
+    }
+
+    // Custom names are only stored once, no matter how many Tiles use them. This also means identical names always have identical indices.
+    for (unsigned int i = 1; i < custom_names_.size(); i++)
+    {
+        if (custom_names_.at(i).compare(new_name)) continue;
+        name_ = i;
+        return;
+    }
+    if (custom_names_.size() > UINT16_MAX) core()->guru()->halt("Too many custom tile names!");
+    name_ = custom_names_.size();
+    custom_names_.push_back(new_name);
 }
 
 // Sets the ASCII character and colour of this Tile, from blood/burns/etc.
@@ -101,23 +131,44 @@ void Tile::set_scars(char ch, Colour col)
 // Sets a TileTag on this Tile.
 void Tile::set_tag(TileTag the_tag, bool changed)
 {
-    if (tags_.count(the_tag) > 0) return;
-    tags_.insert(the_tag);
+    if (tag(the_tag)) return;
+    const uint32_t old_tags = tags_;
+    tags_ |= tag_bit(the_tag);
+    planes_changed(old_tags);
     if (changed && the_tag != TileTag::Changed) set_tag(TileTag::Changed);
 }
 
 // Sets multiple TileTags on this Tile.
-void Tile::set_tags(std::initializer_list<TileTag> tag_list, bool changed) { for (auto &the_tag : tag_list) set_tag(the_tag, changed); }
+void Tile::set_tags(std::initializer_list<TileTag> tag_list, bool changed)
+{
+    const uint32_t bits = tag_bits(tag_list);
+    if ((tags_ & bits) == bits) return;
+    const uint32_t old_tags = tags_;
+    tags_ |= bits;
+    if (changed) tags_ |= tag_bit(TileTag::Changed);
+    planes_changed(old_tags);
+}
 
 // Checks if a TileTag is set on this Tile.
-bool Tile::tag(TileTag the_tag) const { return (tags_.count(the_tag) > 0); }
+bool Tile::tag(TileTag the_tag) const { return (tags_ & tag_bit(the_tag)); }
+
+// Converts a TileTag into its bit in the tag bitmask.
+uint32_t Tile::tag_bit(TileTag the_tag) { return (1U << static_cast<uint16_t>(the_tag)); }
+
+// Converts multiple TileTags into a combined bitmask.
+uint32_t Tile::tag_bits(std::initializer_list<TileTag> tag_list)
+{
+    uint32_t bits = 0;
+    for (auto &the_tag : tag_list)
+        bits |= tag_bit(the_tag);
+    return bits;
+}
 
 // Checks if multiple TileTags are all set on this Tile.
 bool Tile::tags(std::initializer_list<TileTag> tag_list) const
 {
-    for (auto &the_tag : tag_list)
-        if (!tag(the_tag)) return false;
-    return true;
+    const uint32_t bits = tag_bits(tag_list);
+    return ((tags_ & bits) == bits);
 }
 
 }   // namespace invictus
@@ -6,8 +6,8 @@
 
 #include <cstdint>
 #include <initializer_list>
-#include <set>
 #include <string>
+#include <vector>
 
 
 namespace invictus
@@ -17,27 +17,31 @@ enum class Colour : uint8_t;    // defined in terminal/terminal-shared-defs.hpp
 enum class TileID : uint16_t;   // defined in factory/factory-tile.hpp
 
 
-// Tags on a Tile. They're like flags except we don't risk running out of bits on an integer.
+// Tags on a Tile. Each one is a bit index into the Tile's tag bitmask, so these must stay dense, and there can be no more than 32 of them.
+// Save files from before the bitmask used different numeric IDs, which are converted in SaveLoad::load_tile().
 enum class TileTag : uint16_t
 {
     // Basic tags that are common to many Tile types.
-    BlocksMovement = 1, // This Tile blocks anything from moving onto it.
-    BlocksLight = 2,    // This Tile blocks the passage of light.
-    Immutable = 3,      // This Tile is important and should not be changed.
+    BlocksMovement, // This Tile blocks anything from moving onto it.
+    BlocksLight,    // This Tile blocks the passage of light.
+    Immutable,      // This Tile is important and should not be changed.
 
     // Transient tags which are (usually) not defined by default, but are set by player behaviour.
-    Changed = 100,      // This Tile has changed from its stock data.
-    Bloodied = 102,     // This Tile has been splashed with blood and gore.
-    Open = 103,         // This Tile is currently open.
+    Changed,        // This Tile has changed from its stock data.
+    Bloodied,       // This Tile has been splashed with blood and gore.
+    Open,           // This Tile is currently open.
 
     // Special types of Tiles.
-    StairsUp = 200,     // This Tile is an upward stairway.
-    StairsDown = 201,   // This Tile is a downward stairway.
-    Openable = 202,     // This Tile is a door that can be opened.
-    Closeable = 203,    // This Tile is a door that can be closed.
+    StairsUp,       // This Tile is an upward stairway.
+    StairsDown,     // This Tile is a downward stairway.
+    Openable,       // This Tile is a door that can be opened.
+    Closeable,      // This Tile is a door that can be closed.
+
+    _END            // Not a real tag; this must always be last, so we know how many tags there are.
 };
 
 
+// Tiles only store the data that can differ from their TileID's stock prototype (see codex/codex-tile.hpp), to keep Areas small.
 class Tile
 {
 public:
@@ -59,13 +63,19 @@ public:
     bool        tags(std::initializer_list<TileTag> tag_list) const;    // Checks if multiple TileTags are all set on this Tile.
 
 private:
-    char        ascii_;         // The ASCII character used to represent this Tile.
+    void        planes_changed(uint32_t old_tags) const;    // Lets the Area owning this Tile know if its light or movement blocking has changed.
+    static uint32_t tag_bit(TileTag the_tag);   // Converts a TileTag into its bit in the tag bitmask.
+    static uint32_t tag_bits(std::initializer_list<TileTag> tag_list);  // Converts multiple TileTags into a combined bitmask.
+
+    static std::vector<std::string> custom_names_;  // Non-stock Tile names, shared between all Tiles. Index 0 is unused, meaning the stock name.
+
+    char        ascii_;         // The ASCII character used to represent this Tile, if it has been Changed.
     char        ascii_scars_;   // The ASCII character for this Tile when it's been bloodied/burned/etc.
-    Colour      colour_;        // The colour of this Tile.
+    Colour      colour_;        // The colour of this Tile, if it has been Changed.
     Colour      colour_scars_;  // The colour of this Tile when it's been bloodied/burned/etc.
     TileID      id_;            // The template ID of this Tile.
-    std::string name_;          // The name of this Tile.
-    std::set<TileTag>   tags_;  // Any and all TileTags on this Tile.
+    uint16_t    name_;          // The index of this Tile's custom name in custom_names_, or 0 for the stock name.
+    uint32_t    tags_;          // Any and all TileTags on this Tile, as a bitmask.
 
 friend class CodexTile;
 friend class SaveLoad;
@@ -1,6 +1,8 @@
 // codex/codex-tile.cpp -- Factory class, generating preset types of Tiles that make up the game world's structure.
 // Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
 
+#include <vector>
+
 #include "area/tile.hpp"
 #include "codex/codex-tile.hpp"
 #include "core/core.hpp"
@@ -12,96 +14,124 @@
 namespace invictus
 {
 
-// Generates a preset Tile.
-void CodexTile::generate(Tile* tile, TileID id)
+// Builds the stock prototype for a given TileID.
+TilePrototype CodexTile::build_prototype(TileID id)
 {
-    if (!tile) core()->guru()->halt("Attempt to generate nullptr tile!");
-    tile->tags_.clear();
-    tile->id_ = id;
+    TilePrototype proto = { ASCII_NOTHING, Colour::WHITE, "tile", 0 };
 
     switch(id)
     {
         case TileID::VOID_TILE: // This shouldn't really be used for anything, it's just a filler "nothing here" tile.
-            tile->name_ = "void";
-            tile->ascii_ = ASCII_NOTHING;
-            tile->colour_ = Colour::BLACK;
-            tile->set_tag(TileTag::BlocksMovement, false);
+            proto.name = "void";
+            proto.ascii = ASCII_NOTHING;
+            proto.colour = Colour::BLACK;
+            proto.tags = Tile::tag_bit(TileTag::BlocksMovement);
             break;
 
         case TileID::FLOOR_STONE:   // A basic and generic floor tile.
-            tile->name_ = "stone floor";
-            tile->ascii_ = ASCII_GROUND;
-            tile->colour_ = Colour::WHITE;
+            proto.name = "stone floor";
+            proto.ascii = ASCII_GROUND;
+            proto.colour = Colour::WHITE;
             break;
 
         case TileID::WALL_STONE:    // A basic and generic wall tile.
-            tile->name_ = "stone wall";
-            tile->ascii_ = ASCII_WALL;
-            tile->colour_ = Colour::WHITE;
-            tile->set_tags({TileTag::BlocksLight, TileTag::BlocksMovement}, false);
+            proto.name = "stone wall";
+            proto.ascii = ASCII_WALL;
+            proto.colour = Colour::WHITE;
+            proto.tags = Tile::tag_bits({TileTag::BlocksLight, TileTag::BlocksMovement});
             break;
 
         case TileID::STAIRS_DOWN:   // Stairs leading down to the dungeon level below.
-            tile->name_ = "stairs down";
-            tile->ascii_ = ASCII_STAIRS_DOWN;
-            tile->colour_ = Colour::WHITE_BOLD;
-            tile->set_tags({TileTag::Immutable, TileTag::StairsDown}, false);
+            proto.name = "stairs down";
+            proto.ascii = ASCII_STAIRS_DOWN;
+            proto.colour = Colour::WHITE_BOLD;
+            proto.tags = Tile::tag_bits({TileTag::Immutable, TileTag::StairsDown});
             break;
 
         case TileID::STAIRS_UP: // Stairs leading up to the dungeon level (or surface world) above.
-            tile->name_ = "stairs up";
-            tile->ascii_ = ASCII_STAIRS_UP;
-            tile->colour_ = Colour::WHITE_BOLD;
-            tile->set_tags({TileTag::Immutable, TileTag::StairsUp}, false);
+            proto.name = "stairs up";
+            proto.ascii = ASCII_STAIRS_UP;
+            proto.colour = Colour::WHITE_BOLD;
+            proto.tags = Tile::tag_bits({TileTag::Immutable, TileTag::StairsUp});
             break;
 
         case TileID::WALL_BEDROCK:  // Indestructible walls surrounding the map.
-            tile->name_ = "bedrock wall";
-            tile->ascii_ = ASCII_WALL;
-            tile->colour_ = Colour::BLACK_BOLD;
-            tile->set_tags({TileTag::Immutable, TileTag::BlocksMovement, TileTag::BlocksLight}, false);
+            proto.name = "bedrock wall";
+            proto.ascii = ASCII_WALL;
+            proto.colour = Colour::BLACK_BOLD;
+            proto.tags = Tile::tag_bits({TileTag::Immutable, TileTag::BlocksMovement, TileTag::BlocksLight});
             break;
 
         case TileID::LG_FLOOR:  // Dungeon generation: will become walkable floor.
-            tile->name_ = "unfinished floor";
-            tile->ascii_ = ASCII_GROUND;
-            tile->colour_ = Colour::BLACK_BOLD;
+            proto.name = "unfinished floor";
+            proto.ascii = ASCII_GROUND;
+            proto.colour = Colour::BLACK_BOLD;
             break;
 
         case TileID::LG_WALL:   // Dungeon generation: will become a solid wall.
-            tile->name_ = "unfinished wall";
-            tile->ascii_ = ASCII_WALL;
-            tile->colour_ = Colour::BLACK_BOLD;
-            tile->set_tags({TileTag::BlocksLight, TileTag::BlocksMovement}, false);
+            proto.name = "unfinished wall";
+            proto.ascii = ASCII_WALL;
+            proto.colour = Colour::BLACK_BOLD;
+            proto.tags = Tile::tag_bits({TileTag::BlocksLight, TileTag::BlocksMovement});
             break;
 
         case TileID::LG_DOOR_CANDIDATE: // Dungeon generation: may become a door.
-            tile->name_ = "door candidate";
-            tile->ascii_ = ASCII_DOOR_CLOSED;
-            tile->colour_ = Colour::YELLOW;
-            tile->set_tags({TileTag::BlocksLight, TileTag::BlocksMovement}, false);
+            proto.name = "door candidate";
+            proto.ascii = ASCII_DOOR_CLOSED;
+            proto.colour = Colour::YELLOW;
+            proto.tags = Tile::tag_bits({TileTag::BlocksLight, TileTag::BlocksMovement});
             break;
 
         case TileID::LG_FLOOR_CANDIDATE:    // Dungeon generation: may become floor.
-            tile->name_ = "floor candidate";
-            tile->ascii_ = ASCII_GROUND;
-            tile->colour_ = Colour::BLACK_BOLD;
+            proto.name = "floor candidate";
+            proto.ascii = ASCII_GROUND;
+            proto.colour = Colour::BLACK_BOLD;
             break;
 
         case TileID::DRUJ_TOMB: // Druj tombs, which spawn undead.
-            tile->name_ = "druj tomb";
-            tile->ascii_ = ASCII_TOMB;
-            tile->colour_ = Colour::BLACK_BOLD;
-            tile->set_tags({TileTag::BlocksLight, TileTag::BlocksMovement}, false);
+            proto.name = "druj tomb";
+            proto.ascii = ASCII_TOMB;
+            proto.colour = Colour::BLACK_BOLD;
+            proto.tags = Tile::tag_bits({TileTag::BlocksLight, TileTag::BlocksMovement});
             break;
 
         case TileID::DOOR_WOOD: // Wooden door
-            tile->name_ = "wooden door";
-            tile->ascii_ = ASCII_DOOR_CLOSED;
-            tile->colour_ = Colour::YELLOW;
-            tile->set_tags({TileTag::BlocksLight, TileTag::Openable}, false);
+            proto.name = "wooden door";
+            proto.ascii = ASCII_DOOR_CLOSED;
+            proto.colour = Colour::YELLOW;
+            proto.tags = Tile::tag_bits({TileTag::BlocksLight, TileTag::Openable});
             break;
+
+        case TileID::_END: core()->guru()->halt("Attempt to build invalid tile prototype!"); break;
     }
+    return proto;
+}
+
+// Generates a preset Tile.
+void CodexTile::generate(Tile* tile, TileID id)
+{
+    if (!tile) core()->guru()->halt("Attempt to generate nullptr tile!");
+    const TilePrototype &proto = prototype(id);
+    tile->ascii_ = tile->ascii_scars_ = proto.ascii;
+    tile->colour_ = tile->colour_scars_ = proto.colour;
+    tile->id_ = id;
+    tile->name_ = 0;
+    tile->tags_ = proto.tags;
+}
+
+// Retrieves the stock prototype for a given TileID.
+const TilePrototype& CodexTile::prototype(TileID id)
+{
+    // The table is built the first time it's needed. Static local initialization is thread-safe, so this is fine to call from the level generator thread.
+    static const std::vector<TilePrototype> prototypes = []
+    {
+        std::vector<TilePrototype> table;
+        for (uint16_t i = 0; i < static_cast<uint16_t>(TileID::_END); i++)
+            table.push_back(build_prototype(static_cast<TileID>(i)));
+        return table;
+    }();
+    if (id >= TileID::_END) core()->guru()->halt("Invalid TileID requested!", static_cast<int>(id));
+    return prototypes[static_cast<uint16_t>(id)];
 }
 
 }   // namespace invictus
@@ -5,21 +5,38 @@
 #define CODEX_CODEX_TILE_HPP_
 
 #include <cstdint>
+#include <string>
 
 
 namespace invictus
 {
 
+enum class Colour : uint8_t;    // defined in terminal/terminal-shared-defs.hpp
+
 class Tile; // defined in world/tile.hpp
 
 
+// _END is important, so we know how large to make the prototype table.
 enum class TileID : uint16_t { VOID_TILE = 0, FLOOR_STONE, WALL_STONE, STAIRS_DOWN, STAIRS_UP, WALL_BEDROCK, LG_FLOOR, LG_WALL, LG_DOOR_CANDIDATE,
-    LG_FLOOR_CANDIDATE, DRUJ_TOMB, DOOR_WOOD };
+    LG_FLOOR_CANDIDATE, DRUJ_TOMB, DOOR_WOOD, _END };
+
+// The stock, unmodified data for a type of Tile. These are shared by every Tile of the same TileID, so individual Tiles don't need their own copies.
+struct TilePrototype
+{
+    char        ascii;  // The ASCII character used to represent this Tile.
+    Colour      colour; // The colour of this Tile.
+    std::string name;   // The name of this Tile.
+    uint32_t    tags;   // The TileTags set on this Tile, as a bitmask.
+};
 
 class CodexTile
 {
 public:
     static void generate(Tile* tile, TileID id);    // Generates a preset Tile.
+    static const TilePrototype& prototype(TileID id);   // Retrieves the stock prototype for a given TileID.
+
+private:
+    static TilePrototype    build_prototype(TileID id); // Builds the stock prototype for a given TileID.
 };
 
 }       // namespace invictus
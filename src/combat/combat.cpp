@@ -267,7 +267,7 @@ void Combat::perform_attack(std::shared_ptr<Mobile> attacker, std::shared_ptr<Mo
     }
 
     // Roll to hit!
-    const int raw_hit_roll = Random::rng(20);
+    const int raw_hit_roll = Random::rng(20, RNG::COMBAT);
     const int hit_roll = raw_hit_roll + hit_bonus;
 
     // Check if the defender can attempt to block or parry.
@@ -302,7 +302,7 @@ void Combat::perform_attack(std::shared_ptr<Mobile> attacker, std::shared_ptr<Mo
         if (!parried && can_block)
         {
             auto shield_item = defender->equipment(EquipSlot::HAND_OFF);
-            if (shield_item->item_type() == ItemType::SHIELD && shield_item->armour() >= static_cast<int>(Random::rng(20))) blocked = true;
+            if (shield_item->item_type() == ItemType::SHIELD && shield_item->armour() >= static_cast<int>(Random::rng(20, RNG::COMBAT))) blocked = true;
         }
     }
     else evaded = true;
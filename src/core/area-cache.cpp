@@ -0,0 +1,124 @@
+// core/area-cache.cpp -- Keeps recently-visited Areas in memory, and writes them to disk in the background.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+#include "area/area.hpp"
+#include "core/area-cache.hpp"
+#include "core/core.hpp"
+#include "core/game-manager.hpp"
+#include "core/guru.hpp"
+#include "core/save-load.hpp"
+
+
+namespace invictus
+{
+
+// Constructor, sets up an empty cache which can hold up to a given number of Areas.
+AreaCache::AreaCache(unsigned int capacity) : capacity_(capacity), hits_(0), misses_(0), writes_(0) { }
+
+// Drops every cached Area, after waiting for any pending writes to finish.
+void AreaCache::clear()
+{
+    flush();
+    areas_.clear();
+}
+
+// Checks if an Area is either cached, or still waiting to be written to disk.
+bool AreaCache::contains(const std::string &filename) const
+{
+    if (pending_writes_.count(filename)) return true;
+    for (auto &area : areas_)
+        if (!area->filename().compare(filename)) return true;
+    return false;
+}
+
+// Tidies up any background writes which have finished.
+void AreaCache::collect_writes()
+{
+    auto write = pending_writes_.begin();
+    while (write != pending_writes_.end())
+    {
+        auto next = std::next(write);
+        if (write->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) finish_write(write);
+        write = next;
+    }
+}
+
+// Retrieves an Area from the cache, or nullptr if it has to be loaded from disk.
+std::shared_ptr<Area> AreaCache::fetch(const std::string &filename)
+{
+    for (auto it = areas_.begin(); it != areas_.end(); ++it)
+    {
+        if ((*it)->filename().compare(filename)) continue;
+        areas_.splice(areas_.begin(), areas_, it);
+        hits_++;
+        return areas_.front();
+    }
+
+    // If the Area isn't cached, it'll be loaded from disk, so make sure it isn't still being written.
+    misses_++;
+    wait_for(filename);
+    return nullptr;
+}
+
+// Waits for a background write to finish, and reports any errors.
+void AreaCache::finish_write(std::map<std::string, std::future<void>>::iterator write)
+{
+    try { write->second.get(); }
+    catch (std::exception &e) { core()->guru()->nonfatal("Could not write area " + write->first + ": " + e.what(), GURU_ERROR); }
+    pending_writes_.erase(write);
+}
+
+// Waits for every pending write to finish.
+void AreaCache::flush()
+{
+    while (pending_writes_.size())
+        finish_write(pending_writes_.begin());
+}
+
+// Returns a summary of the cache's contents and hit/miss statistics.
+std::string AreaCache::stats() const
+{
+    return std::to_string(areas_.size()) + "/" + std::to_string(capacity_) + " areas cached, " + std::to_string(hits_) + " hits, " +
+        std::to_string(misses_) + " misses, " + std::to_string(writes_) + " writes (" + std::to_string(pending_writes_.size()) + " pending)";
+}
+
+// Adds or refreshes an Area in the cache, and writes it to disk in the background.
+void AreaCache::store(std::shared_ptr<Area> area)
+{
+    // The Area is serialized right away, while nothing else can change it. Only the disk I/O happens on another thread.
+    const std::string filename = area->filename();
+    std::string data = SaveLoad::serialize_area(area);
+    wait_for(filename);
+    pending_writes_[filename] = std::async(std::launch::async, &AreaCache::write_file, core()->game()->save_folder() + "/" + filename + ".dat",
+        std::move(data));
+    writes_++;
+
+    areas_.remove_if([&filename](const std::shared_ptr<Area> &cached) { return !cached->filename().compare(filename); });
+    if (capacity_) areas_.push_front(area);
+    while (areas_.size() > capacity_)
+        areas_.pop_back();
+    collect_writes();
+}
+
+// Waits for any pending write of the specified Area to finish.
+void AreaCache::wait_for(const std::string &filename)
+{
+    auto write = pending_writes_.find(filename);
+    if (write != pending_writes_.end()) finish_write(write);
+}
+
+// Writes a serialized Area to disk. Runs on a worker thread.
+void AreaCache::write_file(const std::string &filename, const std::string &data)
+{
+    std::ofstream area_file(filename, std::ios::out | std::ios::binary);
+    if (!area_file.is_open()) throw std::runtime_error("unable to open " + filename);
+    area_file.write(data.data(), data.size());
+    area_file.close();
+    if (area_file.fail()) throw std::runtime_error("unable to write " + filename);
+}
+
+}   // namespace invictus
@@ -0,0 +1,47 @@
+// core/area-cache.hpp -- Keeps recently-visited Areas in memory, and writes them to disk in the background.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef CORE_AREA_CACHE_HPP_
+#define CORE_AREA_CACHE_HPP_
+
+#include <cstdint>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+
+namespace invictus
+{
+
+class Area; // defined in area/area.hpp
+
+
+class AreaCache
+{
+public:
+                AreaCache(unsigned int capacity);   // Constructor, sets up an empty cache which can hold up to a given number of Areas.
+    void        clear();    // Drops every cached Area, after waiting for any pending writes to finish.
+    bool        contains(const std::string &filename) const;    // Checks if an Area is either cached, or still waiting to be written to disk.
+    std::shared_ptr<Area>   fetch(const std::string &filename); // Retrieves an Area from the cache, or nullptr if it has to be loaded from disk.
+    void        flush();    // Waits for every pending write to finish.
+    std::string stats() const;  // Returns a summary of the cache's contents and hit/miss statistics.
+    void        store(std::shared_ptr<Area> area);  // Adds or refreshes an Area in the cache, and writes it to disk in the background.
+
+private:
+    void        collect_writes();   // Tidies up any background writes which have finished.
+    void        finish_write(std::map<std::string, std::future<void>>::iterator write); // Waits for a background write to finish, and reports any errors.
+    void        wait_for(const std::string &filename);  // Waits for any pending write of the specified Area to finish.
+    static void write_file(const std::string &filename, const std::string &data);  // Writes a serialized Area to disk. Runs on a worker thread.
+
+    std::list<std::shared_ptr<Area>>    areas_; // The cached Areas, with the most recently used at the front.
+    unsigned int    capacity_;  // The maximum number of Areas to keep in memory.
+    uint32_t        hits_;      // How many times an Area was found in the cache.
+    uint32_t        misses_;    // How many times an Area had to be loaded from disk or generated instead.
+    std::map<std::string, std::future<void>>    pending_writes_;    // Background writes which haven't been tidied up yet, by Area filename.
+    uint32_t        writes_;    // How many Areas have been written to disk.
+};
+
+}       // namespace invictus
+#endif  // CORE_AREA_CACHE_HPP_
@@ -10,6 +10,8 @@
 #include "core/guru.hpp"
 #include "core/prefs.hpp"
 #include "dev/acs-display.hpp"
+#include "dev/fov-benchmark.hpp"
+#include "dev/headless.hpp"
 #include "dev/keycode-check.hpp"
 #include "terminal/terminal.hpp"
 #include "ui/msglog.hpp"
@@ -50,8 +52,9 @@ int main(int argc, char** argv)
         bool normal_start = true;
         if (parameters.size() >= 2)
         {
-            for (auto param : parameters)
+            for (unsigned int i = 0; i < parameters.size(); i++)
             {
+                const std::string &param = parameters.at(i);
                 if (!param.compare("-keycode-check"))
                 {
                     invictus::DevKeycodeCheck::begin();
@@ -62,6 +65,22 @@ int main(int argc, char** argv)
                     invictus::DevACSDisplay::display_test();
                     normal_start = false;
                 }
+                if (!param.compare("-fov-benchmark"))
+                {
+                    invictus::DevFovBenchmark::run();
+                    normal_start = false;
+                }
+                const int headless_turns = invictus::DevHeadless::parse_turns(param);
+                if (headless_turns > 0)
+                {
+                    invictus::DevHeadless::run(headless_turns);
+                    normal_start = false;
+                }
+                if (!param.compare("-replay") && i + 1 < parameters.size())
+                {
+                    invictus::DevHeadless::replay(parameters.at(i + 1));
+                    normal_start = false;
+                }
             }
         }
         parameters.clear();
@@ -105,6 +124,7 @@ void Core::cleanup()
         terminal_->cleanup();
         terminal_ = nullptr;
     }
+    DevHeadless::report();  // If the game was running in headless mode, the results can be shown now that the terminal is back to normal.
     if (guru_meditation_)   // Clean up the Guru Meditation system and shut down.
     {
         guru_meditation_->cleanup();
@@ -124,7 +144,7 @@ const std::shared_ptr<Guru> Core::guru() const
 }
 
 // Sets up the core game classes and data, and the terminal subsystem.
-void Core::init(std::vector<std::string>)
+void Core::init(std::vector<std::string> parameters)
 {
     // Create user data folders.
     FileX::make_dir("userdata");
@@ -138,8 +158,16 @@ void Core::init(std::vector<std::string>)
     prefs_->load();
     prefs_->save();
 
-    // Sets up the terminal emulator (Curses)
-    terminal_ = std::make_shared<Terminal>();
+    // Sets up the terminal emulator (Curses), unless we're running in headless mode. Replays are headless too, unless asked to render.
+    bool headless = false, replay = false, render = false;
+    for (auto param : parameters)
+    {
+        if (DevHeadless::parse_turns(param) > 0) headless = true;
+        else if (param == "-replay") replay = true;
+        else if (param == "-render") render = true;
+    }
+    if (replay && !render) headless = true;
+    terminal_ = std::make_shared<Terminal>(headless);
     atexit(Terminal::cleanup);
 
     // Set up the game manager.
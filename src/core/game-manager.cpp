@@ -1,26 +1,36 @@
 // core/game-manager.cpp -- The GameManager class manages the currently-running game state, as well as handling save/load functions.
 // Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
 
+#include <random>
+
 #include "area/area.hpp"
 #include "area/gen-dungeon.hpp"
 #include "area/tile.hpp"
 #include "codex/codex-item.hpp"
 #include "codex/codex-tile.hpp"
+#include "core/area-cache.hpp"
 #include "core/core.hpp"
 #include "core/game-manager.hpp"
 #include "core/guru.hpp"
+#include "core/prefs.hpp"
+#include "core/replay.hpp"
 #include "core/save-load.hpp"
+#include "core/scheduler.hpp"
 #include "core/version.hpp"
 #include "dev/console.hpp"
+#include "dev/headless.hpp"
 #include "entity/item.hpp"
 #include "entity/player.hpp"
 #include "terminal/terminal.hpp"
+#include "tune/area-generation.hpp"
 #include "tune/timing.hpp"
+#include "ui/msglog.hpp"
 #include "ui/system-menu.hpp"
 #include "ui/title.hpp"
 #include "ui/ui.hpp"
 #include "ui/wiki.hpp"
 #include "util/filex.hpp"
+#include "util/random.hpp"
 #include "util/strx.hpp"
 
 
@@ -32,8 +42,9 @@ uint8_t GameManager::skull_pattern[4] = { 0x70, 0xFA, 0xED, 0xFB };
 
 
 // Constructor, sets default values.
-GameManager::GameManager() : area_(nullptr), cleanup_done_(false), game_state_(GameState::INITIALIZING), heartbeat_(0), heartbeat10_(0),
-    player_(std::make_shared<Player>()), save_folder_("userdata/save"), ui_(std::make_shared<UI>())
+GameManager::GameManager() : area_(nullptr), area_cache_(std::make_unique<AreaCache>(core()->prefs()->area_cache_size())), cleanup_done_(false),
+    game_seed_(0), game_state_(GameState::INITIALIZING), heartbeat_(0), next_area_level_(0), player_(std::make_shared<Player>()),
+    save_folder_("userdata/save"), scheduler_(std::make_unique<Scheduler>()), ui_(std::make_shared<UI>())
 { core()->guru()->log("Game manager ready!"); }
 
 // Destructor, calls cleanup code.
@@ -42,12 +53,22 @@ GameManager::~GameManager() { cleanup(); }
 // Returns a pointer to the currently-loaded Area, if any.
 const std::shared_ptr<Area> GameManager::area() const { return area_; }
 
+// Returns the cache of recently-visited Areas.
+AreaCache* GameManager::area_cache() const { return area_cache_.get(); }
+
 // Cleans up anything that needs cleaning up.
 void GameManager::cleanup()
 {
     if (cleanup_done_) return;
     cleanup_done_ = true;
     if (core()->guru()) core()->guru()->log("Cleaning up the game state.");
+    Replay::stop();
+    discard_pregenerated_level();
+    if (area_cache_)
+    {
+        core()->guru()->log("Area cache: " + area_cache_->stats());
+        area_cache_->clear();
+    }
     if (ui_)
     {
         ui_->cleanup();
@@ -70,6 +91,17 @@ void GameManager::die()
     game_state_ = GameState::DUNGEON_DEAD;
 }
 
+// Discards the level being generated in the background, if any, waiting for the generator to finish.
+void GameManager::discard_pregenerated_level()
+{
+    if (!next_area_.valid()) return;
+    next_area_.wait();
+
+    // If the generator failed for some reason, there's no need to report it here; the level will just be generated again if it's ever needed.
+    try { next_area_.get(); }
+    catch (std::exception &e) { core()->guru()->log("Discarded background level generation failure: " + std::string(e.what()), GURU_WARN); }
+}
+
 void GameManager::dungeon_input(int key)
 {
     int dx = 0, dy = 0;
@@ -96,6 +128,7 @@ void GameManager::dungeon_input(int key)
         case 'g': player_->get_item(); break;               // Picks something up.
         case 'i': player_->take_inventory(); break;         // Interact with carried items.
         case 'o': player_->open_a_door(); break;            // Attempts to open something.
+        case 'M': ui_->msglog()->scrollback(); break;       // Scrolls back through older messages.
         case 'R': player_->rest(); break;                   // Rests for a while.
         case 'S': SaveLoad::save_game(); break;             // Saves the game!'
     }
@@ -108,7 +141,25 @@ void GameManager::dungeon_input(int key)
 }
 
 // Deletes the save files in the current save folder.
-void GameManager::erase_save_files() { FileX::delete_files_in_dir(save_folder_); }
+void GameManager::erase_save_files()
+{
+    area_cache_->clear();
+    FileX::delete_files_in_dir(save_folder_);
+}
+
+// Passes time quickly while the player is resting, until something wakes them up.
+void GameManager::fast_forward_rest()
+{
+    // Nothing needs to be drawn until the player wakes up, so this skips the rest of the game loop entirely, and just runs the world one turn at a
+    // time. Taking damage, or a loud enough message, will wake the player up on its own.
+    while (!player_->is_awake() && !player_->is_dead() && game_state_ == GameState::DUNGEON)
+    {
+        player_->reduce_rest_time(1.0f);
+        pass_time(1.0f);
+        tick();
+        if (!player_->is_awake() && area_->hostile_in_fov()) player_->wake();
+    }
+}
 
 // Brøther, may I have some lööps?
 void GameManager::game_loop()
@@ -116,13 +167,13 @@ void GameManager::game_loop()
     auto terminal = core()->terminal();
     auto guru = core()->guru();
 
-    // The entry game state should be TITLE by this point.
+    // The entry game state should be TITLE by this point, or NEW_GAME if headless mode is skipping the title screen.
     if (game_state_ == GameState::TITLE)
     {
         auto title = std::make_unique<TitleScreen>();
         title->title_screen();
     }
-    else core()->guru()->halt("Unknown entry game state", static_cast<int>(game_state_));
+    else if (game_state_ != GameState::NEW_GAME) core()->guru()->halt("Unknown entry game state", static_cast<int>(game_state_));
 
     if (game_state_ == GameState::NEW_GAME)
     {
@@ -131,7 +182,10 @@ void GameManager::game_loop()
     }
     else if (game_state_ == GameState::LOAD_GAME)
     {
-        SaveLoad::load_game("userdata/save");
+        discard_pregenerated_level();
+        area_cache_->clear();
+        SaveLoad::load_game(save_folder_);
+        pregenerate_level();
         ui_->window_resized();
     }
     else core()->guru()->halt("Unknown entry game state", static_cast<int>(game_state_));
@@ -140,16 +194,22 @@ void GameManager::game_loop()
     int key = 0;
     while (true)
     {
-        switch(game_state_)
         {
-            case GameState::DUNGEON: dungeon_input(key); break;
-            case GameState::DUNGEON_DEAD: if (key == ' ') game_over_screen(GameOverType::DEAD); break;
-            default:
-                guru->halt("Invalid game state!", static_cast<int>(game_state_));
-                break;
+            DevHeadless::Scope timer(HeadlessTimer::INPUT);
+            switch(game_state_)
+            {
+                case GameState::DUNGEON: dungeon_input(key); break;
+                case GameState::DUNGEON_DEAD: if (key == ' ') game_over_screen(GameOverType::DEAD); break;
+                default:
+                    guru->halt("Invalid game state!", static_cast<int>(game_state_));
+                    break;
+            }
         }
 
-        tick();
+        {
+            DevHeadless::Scope timer(HeadlessTimer::TICK);
+            tick();
+        }
         if (player_->is_dead())
         {
             player_->wake();
@@ -158,14 +218,17 @@ void GameManager::game_loop()
 
         if (player_->is_awake())
         {
-            ui_->render();
+            {
+                DevHeadless::Scope timer(HeadlessTimer::RENDER);
+                ui_->render();
+            }
             key = terminal->get_key();
             if (key == Key::RESIZE) ui_->window_resized();
         }
         else
         {
-            player_->reduce_rest_time(1.0f);
-            pass_time(1.0f);
+            DevHeadless::Scope timer(HeadlessTimer::TICK);
+            fast_forward_rest();
             key = 0;
         }
     }
@@ -229,6 +292,17 @@ void GameManager::game_over_screen(GameOverType type)
 // Retrieves the current state of the game.
 GameState GameManager::game_state() const { return game_state_; }
 
+// Generates a new dungeon level. This is also run on a worker thread by pregenerate_level(), so it mustn't touch the current game state.
+std::shared_ptr<Area> GameManager::generate_level(const std::string &file, int level, uint32_t seed)
+{
+    auto area = std::make_shared<Area>(50, 50);
+    area->set_level(level);
+    area->set_file(file);
+    auto generator = std::make_unique<DungeonGenerator>(area, seed);
+    generator->generate();
+    return area;
+}
+
 // Gets a key from the user, while handling UI resizing internally.
 int GameManager::get_key()
 {
@@ -261,63 +335,98 @@ bool GameManager::is_key_southwest(int key) { return (key == Key::KP1 || key ==
 // Checks if a key is one of the valid options for moving west or going left in a menu.
 bool GameManager::is_key_west(int key) { return (key == Key::ARROW_LEFT || key == Key::KP4 || key == 'h'); }
 
+// Works out the random seed used to generate a specified level.
+uint32_t GameManager::level_seed(const std::string &file, int level) const
+{
+    // A simple FNV-1a hash of the level's filename and depth, mixed with the game's own seed.
+    uint32_t hash = 2166136261U ^ game_seed_;
+    for (auto ch : file)
+    {
+        hash ^= static_cast<uint8_t>(ch);
+        hash *= 16777619U;
+    }
+    hash ^= static_cast<uint32_t>(level);
+    hash *= 16777619U;
+    return hash;
+}
+
 // Sets up for a new game.
 void GameManager::new_game()
 {
+    discard_pregenerated_level();
     erase_save_files();
-    area_ = std::make_shared<Area>(50, 50);
-    area_->set_level(1);
-    area_->set_file("tfk");
-    auto generator = std::make_unique<DungeonGenerator>(area_);
-    generator->generate();
+
+    // A replay starts from the same seed as the recorded game, and any other new game (except the headless bot's) is recorded, ready to be replayed.
+    if (Replay::playing()) game_seed_ = Replay::seed();
+    else game_seed_ = std::random_device()();
+    Random::seed(game_seed_);
+    heartbeat_ = 0;
+    scheduler_->clear();
+    if (!DevHeadless::active()) Replay::start_recording("userdata/replay.dat", game_seed_);
+    area_ = obtain_level("tfk", 1);
     auto stair_coords = area_->find_tile_tag(TileTag::StairsUp);
     player_->set_pos(stair_coords.first, stair_coords.second);
     player_->set_equipment(EquipSlot::BODY, ItemID::LEATHER_ARMOUR);
     player_->set_equipment(EquipSlot::HAND_MAIN, ItemID::LONGSWORD);
     game_state_ = GameState::DUNGEON;
     ui_->dungeon_mode_ui(true);
+    pregenerate_level();
 }
 
-// The player has taken an action which causes some time to pass.
-void GameManager::pass_time(float time)
+// Retrieves a new level, from the background generator if possible.
+std::shared_ptr<Area> GameManager::obtain_level(const std::string &file, int level)
 {
-    heartbeat_ += time;
-    heartbeat10_ += time;
+    // The background generator uses the same seed as generating the level right now would, so the end result is identical either way.
+    if (next_area_.valid() && next_area_level_ == level && !next_area_file_.compare(file)) return next_area_.get();
+    return generate_level(file, level, level_seed(file, level));
 }
 
+// The player has taken an action which causes some time to pass.
+void GameManager::pass_time(float time) { heartbeat_ += time; }
+
 // Returns a pointer to the player character object.
 const std::shared_ptr<Player> GameManager::player() const { return player_; }
 
+// Starts generating the level below the current one in the background, if it hasn't been visited yet.
+void GameManager::pregenerate_level()
+{
+    if (!area_ || area_->level() >= DUNGEON_LEVELS) return;
+    const std::string file = area_->file_str();
+    const int level = area_->level() + 1;
+    if (next_area_.valid() && next_area_level_ == level && !next_area_file_.compare(file)) return;
+    if (area_cache_->contains(file + std::to_string(level)) || FileX::file_exists(save_folder_ + "/" + file + std::to_string(level) + ".dat")) return;
+
+    discard_pregenerated_level();
+    next_area_file_ = file;
+    next_area_level_ = level;
+    next_area_ = std::async(std::launch::async, &GameManager::generate_level, file, level, level_seed(file, level));
+}
+
+// Returns the Scheduler, which decides when each Mobile acts.
+Scheduler* GameManager::scheduler() const { return scheduler_.get(); }
+
 // Retrieves the name of the saved game folder currently in use.
 const std::string GameManager::save_folder() const { return save_folder_; }
 
 // Sets the game state.
 void GameManager::set_game_state(GameState new_state) { game_state_ = new_state; }
 
+// Changes the saved game folder in use.
+void GameManager::set_save_folder(const std::string &folder) { save_folder_ = folder; }
+
 // Processes non-player actions and progresses the world state.
 void GameManager::tick()
 {
     if (!area_) return;
 
+    // Only whole ticks are handed over to the Scheduler; any fraction left over is kept until the player's next action.
+    uint32_t ticks = 0;
     while (heartbeat_ >= TICK_SPEED)
     {
         heartbeat_ -= TICK_SPEED;
-        for (auto entity : *area_->entities())
-        {
-            if (game_state_ != GameState::DUNGEON) break;   // If the game state changes, just stop processing Entity ticks.
-            entity->tick(entity);
-        }
-    }
-
-    while (heartbeat10_ >= TICK_SPEED * 10)
-    {
-        heartbeat10_ -= TICK_SPEED * 10;
-        for (auto entity : *area_->entities())
-        {
-            if (game_state_ != GameState::DUNGEON) break;   // If the game state changes, just stop processing Entity ticks.
-            entity->tick10(entity);
-        }
+        ticks++;
     }
+    scheduler_->run(ticks);
 }
 
 // Returns a pointer to the user interface manager.
@@ -341,6 +450,7 @@ void GameManager::use_stairs(bool up)
         return;
     }
 
+    DevHeadless::Scope timer(HeadlessTimer::STAIRS);
     int current_level = area_->level();
     int new_level = current_level + (up ? -1 : 1);
 
@@ -348,7 +458,7 @@ void GameManager::use_stairs(bool up)
     if (player_->equipment(EquipSlot::HEAD)->name() == "{M}The Crown of Kings") has_crown_of_kings = true;
     else
     {
-        for (auto item : *player_->inv())
+        for (auto &item : *player_->inv())
         {
             if (item->name() == "{M}The Crown of Kings")
             {
@@ -370,7 +480,8 @@ void GameManager::use_stairs(bool up)
 
     std::string current_area_string = area_->file_str();
     area_->set_player_left(player_->x(), player_->y());
-    SaveLoad::save_area_to_file(save_folder_ + "/" + area_->filename() + ".dat", area_);
+    scheduler_->sync();
+    area_cache_->store(area_);
     std::string travel_string;
     if (up) travel_string = "{c}You ascend the stairs to the previous level...";
     else travel_string = "{c}You descend the stairs to the next level...";
@@ -383,35 +494,33 @@ void GameManager::use_stairs(bool up)
         else game_over_screen(GameOverType::FAILED);
     }
 
-    // Check if the new Area should be loaded from a file, or generated fresh.
+    // Check if the new Area is still in memory, or should be loaded from a file, or generated fresh.
     std::string filename = save_folder_ + "/" + current_area_string + std::to_string(new_level) + ".dat";
     core()->guru()->log(filename);
-    if (FileX::file_exists(filename))
+    auto cached_area = area_cache_->fetch(current_area_string + std::to_string(new_level));
+    if (cached_area || FileX::file_exists(filename))
     {
-        area_ = SaveLoad::load_area_from_file(filename);
+        area_ = (cached_area ? cached_area : SaveLoad::load_area_from_file(filename));
         auto stair_coords = area_->get_player_left();
         player_->set_pos(stair_coords.first, stair_coords.second);
     }
     else
     {
-        area_ = std::make_shared<Area>(50, 50);
-        area_->set_level(new_level);
-        area_->set_file(current_area_string);
-        auto generator = std::make_unique<DungeonGenerator>(area_);
-        generator->generate();
+        area_ = obtain_level(current_area_string, new_level);
         auto stair_coords = area_->find_tile_tag(up ? TileTag::StairsDown : TileTag::StairsUp);
         player_->set_pos(stair_coords.first, stair_coords.second);
 
         // If this is the lowest level, place the Crown of Kings where the down staircase would be.
-        if (new_level == 5)
+        if (new_level == DUNGEON_LEVELS)
         {
             auto down_stairs = area_->find_tile_tag(TileTag::StairsDown);
             area_->set_tile(down_stairs.first, down_stairs.second, TileID::FLOOR_STONE);
             auto crown = CodexItem::generate(ItemID::CROWN_OF_KINGS);
             crown->set_pos(down_stairs.first, down_stairs.second);
-            area_->entities()->push_back(crown);
+            area_->add_entity(crown);
         }
     }
+    pregenerate_level();
     ui_->full_redraw();
     SaveLoad::save_game();
 }
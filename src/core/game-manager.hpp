@@ -5,6 +5,7 @@
 #define CORE_GAME_MANAGER_HPP_
 
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
 
@@ -13,7 +14,9 @@ namespace invictus
 {
 
 class Area;     // defined in area/area.hpp
+class AreaCache;    // defined in core/area-cache.hpp
 class Player;   // defined in entity/player.hpp
+class Scheduler;    // defined in core/scheduler.hpp
 class UI;       // defined in ui/ui.hpp
 
 
@@ -44,25 +47,40 @@ public:
     void        pass_time(float time);      // The player has taken an action which causes some time to pass.
     const std::string save_folder() const;  // Retrieves the name of the saved game folder currently in use.
     void        set_game_state(GameState new_state);    // Sets the game state.
+    void        set_save_folder(const std::string &folder); // Changes the saved game folder in use.
     void        tick();             // Processes non-player actions and progresses the world state.
 
     const std::shared_ptr<Area>     area() const;   // Returns a pointer to the currently-loaded Area, if any.
+    AreaCache*                      area_cache() const; // Returns the cache of recently-visited Areas.
     const std::shared_ptr<Player>   player() const; // Returns a pointer to the player character object.
+    Scheduler*                      scheduler() const;  // Returns the Scheduler, which decides when each Mobile acts.
     const std::shared_ptr<UI>       ui() const;     // Returns a pointer to the user interface manager.
 
 private:
+    void    discard_pregenerated_level();   // Discards the level being generated in the background, if any, waiting for the generator to finish.
     void    dungeon_input(int key);     // Handles the player's input, when in dungeon mode.
+    void    fast_forward_rest();        // Passes time quickly while the player is resting, until something wakes them up.
     void    game_over_screen(GameOverType type);        // Renders the game-over screen.
+    uint32_t    level_seed(const std::string &file, int level) const;   // Works out the random seed used to generate a specified level.
     void    new_game();                 // Sets up for a new game.
+    std::shared_ptr<Area>   obtain_level(const std::string &file, int level);   // Retrieves a new level, from the background generator if possible.
+    void    pregenerate_level();        // Starts generating the level below the current one in the background, if it hasn't been visited yet.
     void    use_stairs(bool up);        // Attempts to go up or down stairs.
 
+    static std::shared_ptr<Area>    generate_level(const std::string &file, int level, uint32_t seed);  // Generates a new dungeon level.
+
     std::shared_ptr<Area>   area_;  // The currently-loaded Area of the game world.
+    std::unique_ptr<AreaCache>  area_cache_;    // Recently-visited Areas, kept in memory and written to disk in the background.
     bool        cleanup_done_;      // Has the cleanup routine already run once?
+    uint32_t    game_seed_;         // The random seed for this game, which every level's own seed is derived from.
     GameState   game_state_;        // The current game state.
-    float       heartbeat_;         // The main timer of the world, incremented when the player takes actions.
-    float       heartbeat10_;       // As above, but this one's a slower heartbeat that causes things like buffs/debuffs to trigger at a 1/10 speed rate
+    float       heartbeat_;         // The main timer of the world, incremented when the player takes actions, and spent by the Scheduler in whole ticks.
+    std::future<std::shared_ptr<Area>>  next_area_; // A level being generated in the background, ready for when the player takes the stairs.
+    std::string next_area_file_;    // The filename section of the level being generated in the background.
+    int         next_area_level_;   // The vertical level of the level being generated in the background.
     std::shared_ptr<Player> player_;    // The player character object.
     std::string save_folder_;       // The saved game folder currently in use.
+    std::unique_ptr<Scheduler>  scheduler_; // Decides when each Mobile in the current Area acts, and when its slower tick10() events happen.
     std::shared_ptr<UI> ui_;        // The user interface manager.
 
     static uint8_t skull_pattern[4];    // The skull symbol to render on the game-over screen.
@@ -4,6 +4,7 @@
 #include <csignal>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 
 #include "core/core.hpp"
 #include "core/guru.hpp"
@@ -24,7 +25,7 @@ void guru_intercept_signal(int sig) { core()->guru()->intercept_signal(sig); }
 
 // Opens the output log for messages.
 Guru::Guru(std::string log_filename) : cascade_count_(0), cascade_failure_(false), cascade_timer_(std::time(0)), cleanup_done_(false), console_ready_(false),
-    dead_already_(false), stderr_buffer_(new std::stringstream()), stderr_old_(nullptr)
+    dead_already_(false), main_thread_(std::this_thread::get_id()), stderr_buffer_(new std::stringstream()), stderr_old_(nullptr)
 {
     if (!log_filename.size()) exit(EXIT_FAILURE);
     FileX::delete_file(log_filename);
@@ -87,6 +88,12 @@ void Guru::console_ready(bool is_ready) { console_ready_ = is_ready; }
 // Guru meditation error.
 void Guru::halt(std::string error, int a, int b)
 {
+    // Worker threads can't render anything, so the error is passed back as an exception, to be rethrown on the main thread when the work is collected.
+    if (std::this_thread::get_id() != main_thread_)
+    {
+        this->log("Critical error occurred on a worker thread: " + error, GURU_CRITICAL);
+        throw std::runtime_error(error);
+    }
     this->log("Critical error occurred, halting execution.", GURU_CRITICAL);
     this->log(error, GURU_CRITICAL);
     if (dead_already_)
@@ -178,6 +185,7 @@ bool Guru::is_dead() const { return dead_already_; }
 // Logs a message in the system log file.
 void Guru::log(std::string msg, int type)
 {
+    std::lock_guard<std::mutex> lock(log_mutex_);
     if (!syslog_.is_open()) return;
 
     std::string txt_tag;
@@ -7,8 +7,10 @@
 #include <ctime>
 #include <exception>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 
 
 namespace invictus
@@ -42,6 +44,8 @@ private:
     bool                cleanup_done_;      // Has the cleanup routine already run once?
     bool                console_ready_;     // Have we fully initialized the console yet?
     bool                dead_already_;      // Have we already died? Is this crash within the Guru subsystem?
+    std::mutex          log_mutex_;         // Stops worker threads (such as the level generator) from writing to the log at the same time.
+    std::thread::id     main_thread_;       // The thread Guru was created on, which is the only one allowed to take over the screen.
     std::stringstream*  stderr_buffer_;     // Pointer to a stringstream buffer used to catch stderr messages.
     std::streambuf*     stderr_old_;        // The old stderr buffer.
     std::ofstream       syslog_;            // The system log file.
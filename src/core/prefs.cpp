@@ -15,7 +15,8 @@ namespace invictus
 {
 
 // Constructor, sets default values.
-Prefs::Prefs(std::string filename) : filename_(filename), pathfind_euclidean_(true), use_colour_(true)
+Prefs::Prefs(std::string filename) : area_cache_size_(4), filename_(filename), pathfind_euclidean_(true), terminal_backend_(TerminalBackend::DEFAULT),
+    use_colour_(true)
 {
 #ifdef INVICTUS_TARGET_WINDOWS
     acs_flags_ = 15;
@@ -28,6 +29,9 @@ Prefs::Prefs(std::string filename) : filename_(filename), pathfind_euclidean_(tr
 // Retrieves the ACS glyph usage flags.
 uint8_t Prefs::acs_flags() const { return acs_flags_; }
 
+// Retrieves the number of recently-visited Areas to keep in memory.
+uint8_t Prefs::area_cache_size() const { return area_cache_size_; }
+
 // Loads user prefs from a file, if it exists.
 void Prefs::load()
 {
@@ -56,7 +60,15 @@ void Prefs::load()
             pref = StrX::str_tolower(pref_vec.at(0));
             pref_val = pref_vec.at(1);
             if (!pref.compare("acs_flags")) acs_flags_ = std::stoi(pref_val);
+            else if (!pref.compare("area_cache_size")) area_cache_size_ = std::stoi(pref_val);
             else if (!pref.compare("pathfind_euclidean")) pathfind_euclidean_ = StrX::str_to_bool(pref_val);
+            else if (!pref.compare("terminal_backend"))
+            {
+                const std::string backend = StrX::str_tolower(pref_val);
+                if (!backend.compare("curses")) terminal_backend_ = TerminalBackend::DEFAULT;
+                else if (!backend.compare("ansi")) terminal_backend_ = TerminalBackend::ANSI;
+                else guru->nonfatal("Invalid terminal backend in " + filename_ + ": " + pref_val, GURU_WARN);
+            }
             else if (!pref.compare("use_colour")) use_colour_ = StrX::str_to_bool(pref_val);
             else guru->nonfatal("Invalid line in " + filename_ + ": " + line, GURU_WARN);
         }
@@ -72,11 +84,16 @@ void Prefs::save()
 {
     std::ofstream save_file(filename_);
     save_file << "acs_flags:" << std::to_string(acs_flags_) << std::endl;
+    save_file << "area_cache_size:" << std::to_string(area_cache_size_) << std::endl;
     save_file << "pathfind_euclidean:" << StrX::bool_to_str(pathfind_euclidean_) << std::endl;
+    save_file << "terminal_backend:" << (terminal_backend_ == TerminalBackend::ANSI ? "ansi" : "curses") << std::endl;
     save_file << "use_colour:" << StrX::bool_to_str(use_colour_) << std::endl;
     save_file.close();
 }
 
+// Retrieves the backend the Terminal uses to draw the screen.
+TerminalBackend Prefs::terminal_backend() const { return terminal_backend_; }
+
 // Check if using colour is allowed.
 bool Prefs::use_colour() const { return use_colour_; }
 
@@ -7,6 +7,8 @@
 #include <cstdint>
 #include <string>
 
+#include "terminal/terminal-shared-defs.hpp"
+
 
 namespace invictus
 {
@@ -16,15 +18,19 @@ class Prefs
 public:
             Prefs(std::string filename);    // Constructor, sets default values.
     uint8_t acs_flags() const;          // Retrieves the ACS glyph usage flags.
+    uint8_t area_cache_size() const;    // Retrieves the number of recently-visited Areas to keep in memory.
     void    load();                     // Loads user prefs from a file, if it exists.
     bool    pathfind_euclidean() const; // Is the pathfinding code using the Euclidean method (true) or the Manhattan method (false)?
     void    save();                     // Saves user prefs to a file.
+    TerminalBackend terminal_backend() const;   // Retrieves the backend the Terminal uses to draw the screen.
     bool    use_colour() const;         // Check if using colour is allowed.
 
 private:
     uint8_t     acs_flags_;             // The ACS glyph usage flags.
+    uint8_t     area_cache_size_;       // The number of recently-visited Areas to keep in memory.
     std::string filename_;              // The filename of the user prefs file.
     bool        pathfind_euclidean_;    // Does the pathfinding code use the Euclidean method (as opposed to the Manhattan method)?
+    TerminalBackend terminal_backend_;  // The backend the Terminal uses to draw the screen.
     bool        use_colour_;            // Is colour enabled?
 };
 
@@ -0,0 +1,162 @@
+// core/replay.cpp -- Records the random seed and every keypress of a game into a compact replay file, and plays them back deterministically.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#include <iterator>
+
+#include "core/core.hpp"
+#include "core/guru.hpp"
+#include "core/replay.hpp"
+#include "core/save-load.hpp"
+#include "terminal/terminal-shared-defs.hpp"
+#include "util/strx.hpp"
+
+
+namespace invictus
+{
+
+uint64_t        Replay::checksum_ = 0;          // The checksum of the game state at the end of the recording.
+bool            Replay::has_checksum_ = false;  // Was a final checksum recorded? (If the game crashed, it might not have been.)
+size_t          Replay::key_pos_ = 0;           // The position of the next key to play back.
+std::vector<int>    Replay::keys_;              // The keypresses being played back.
+bool            Replay::playing_ = false;       // Is a replay being played back?
+std::ofstream   Replay::record_file_;           // The replay file being recorded.
+bool            Replay::recording_ = false;     // Is a replay being recorded?
+uint32_t        Replay::seed_ = 0;              // The game seed of the replay being played back.
+std::string     Replay::verify_result_;         // The result of checking the played-back game's final state against the recording.
+
+// Loads a replay file for playback. Returns false if it couldn't be read.
+bool Replay::load(const std::string &filename)
+{
+    std::ifstream replay_file(filename, std::ios::in | std::ios::binary);
+    if (!replay_file.good()) return false;
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(replay_file)), std::istreambuf_iterator<char>());
+    replay_file.close();
+
+    auto read_u32 = [&data](size_t pos) -> uint32_t
+    { return data.at(pos) | (data.at(pos + 1) << 8) | (data.at(pos + 2) << 16) | (static_cast<uint32_t>(data.at(pos + 3)) << 24); };
+    if (data.size() < 12 || read_u32(0) != REPLAY_MAGIC) return false;
+    if (read_u32(4) != REPLAY_VERSION)
+    {
+        core()->guru()->log("Incompatible replay file version: " + std::to_string(read_u32(4)), GURU_ERROR);
+        return false;
+    }
+    seed_ = read_u32(8);
+
+    // Each key is stored as a variable-length number, offset by one, so that a zero can mark the end of the keys and the start of the checksum.
+    keys_.clear();
+    has_checksum_ = false;
+    size_t pos = 12;
+    while (pos < data.size())
+    {
+        uint32_t value = 0;
+        int shift = 0;
+        while (pos < data.size())
+        {
+            const uint8_t byte = data.at(pos++);
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) break;
+        }
+        if (value)
+        {
+            keys_.push_back(static_cast<int>(value - 1));
+            continue;
+        }
+        if (pos + 8 <= data.size())
+        {
+            checksum_ = 0;
+            for (int i = 7; i >= 0; i--)
+                checksum_ = (checksum_ << 8) | data.at(pos + i);
+            has_checksum_ = true;
+        }
+        break;
+    }
+
+    key_pos_ = 0;
+    playing_ = true;
+    core()->guru()->log("Loaded replay file " + filename + " (" + std::to_string(keys_.size()) + " keypresses).");
+    return true;
+}
+
+// Retrieves the next recorded keypress during playback, or returns false if there are none left.
+bool Replay::next_key(int *key)
+{
+    if (!playing_ || key_pos_ >= keys_.size()) return false;
+    *key = keys_.at(key_pos_++);
+    return true;
+}
+
+// Checks if a replay is being played back.
+bool Replay::playing() { return playing_; }
+
+// Records a keypress, if a replay is being recorded.
+void Replay::record_key(int key)
+{
+    if (!recording_) return;
+    if (key < 0) key = Key::UNKNOWN_KEY;
+    write_varint(static_cast<uint32_t>(key) + 1);
+}
+
+// Retrieves the game seed of the replay being played back.
+uint32_t Replay::seed() { return seed_; }
+
+// Starts recording a new replay, for a game started with the given seed.
+void Replay::start_recording(const std::string &filename, uint32_t seed)
+{
+    if (playing_) return;
+    if (recording_) record_file_.close();
+    record_file_.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!record_file_.good())
+    {
+        core()->guru()->nonfatal("Could not open replay file for writing: " + filename, GURU_WARN);
+        recording_ = false;
+        return;
+    }
+    const uint32_t header[3] = { REPLAY_MAGIC, REPLAY_VERSION, seed };
+    for (auto value : header)
+        for (int i = 0; i < 4; i++)
+            record_file_.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+    recording_ = true;
+}
+
+// Stops recording or playing back, and records or checks the final state of the game.
+void Replay::stop()
+{
+    if (recording_)
+    {
+        const uint64_t checksum = SaveLoad::state_checksum();
+        write_varint(0);
+        for (int i = 0; i < 8; i++)
+            record_file_.put(static_cast<char>((checksum >> (i * 8)) & 0xFF));
+        record_file_.close();
+        recording_ = false;
+    }
+    if (playing_)
+    {
+        const uint64_t checksum = SaveLoad::state_checksum();
+        const bool matched = (has_checksum_ && checksum == checksum_ && key_pos_ >= keys_.size());
+        if (key_pos_ < keys_.size()) verify_result_ = "Replay stopped early, with " + std::to_string(keys_.size() - key_pos_) + " keypresses remaining.";
+        else if (!has_checksum_) verify_result_ = "No final game state was recorded, so the result can't be checked.";
+        else if (matched) verify_result_ = "Final game state matches the recording (" + StrX::itoh(checksum >> 32, 8) + StrX::itoh(checksum & 0xFFFFFFFF, 8) +
+            ").";
+        else verify_result_ = "Final game state DOES NOT match the recording!";
+        core()->guru()->log(verify_result_, (matched ? GURU_INFO : GURU_WARN));
+        playing_ = false;
+    }
+}
+
+// Describes whether the replay that was played back ended in the same state as the recording.
+std::string Replay::verify_result() { return verify_result_; }
+
+// Writes a number to the replay file, using as few bytes as possible.
+void Replay::write_varint(uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        record_file_.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    record_file_.put(static_cast<char>(value));
+}
+
+}   // namespace invictus
@@ -0,0 +1,46 @@
+// core/replay.hpp -- Records the random seed and every keypress of a game into a compact replay file, and plays them back deterministically.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef CORE_REPLAY_HPP_
+#define CORE_REPLAY_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace invictus
+{
+
+class Replay
+{
+public:
+    static bool         load(const std::string &filename);  // Loads a replay file for playback. Returns false if it couldn't be read.
+    static bool         next_key(int *key); // Retrieves the next recorded keypress during playback, or returns false if there are none left.
+    static bool         playing();  // Checks if a replay is being played back.
+    static void         record_key(int key);    // Records a keypress, if a replay is being recorded.
+    static uint32_t     seed();     // Retrieves the game seed of the replay being played back.
+    static void         start_recording(const std::string &filename, uint32_t seed);   // Starts recording a new replay, for a game started with the given seed.
+    static void         stop(); // Stops recording or playing back, and records or checks the final state of the game.
+    static std::string  verify_result();    // Describes whether the replay that was played back ended in the same state as the recording.
+
+private:
+    static constexpr uint32_t   REPLAY_MAGIC =      0x50525649; // The first four bytes of a replay file ("IVRP").
+    static constexpr uint32_t   REPLAY_VERSION =    2;  // The replay file format version. Replays are only compatible with the same version.
+
+    static void         write_varint(uint32_t value);   // Writes a number to the replay file, using as few bytes as possible.
+
+    static uint64_t     checksum_;      // The checksum of the game state at the end of the recording.
+    static bool         has_checksum_;  // Was a final checksum recorded? (If the game crashed, it might not have been.)
+    static size_t       key_pos_;       // The position of the next key to play back.
+    static std::vector<int> keys_;      // The keypresses being played back.
+    static bool         playing_;       // Is a replay being played back?
+    static std::ofstream    record_file_;   // The replay file being recorded.
+    static bool         recording_;     // Is a replay being recorded?
+    static uint32_t     seed_;          // The game seed of the replay being played back.
+    static std::string  verify_result_; // The result of checking the played-back game's final state against the recording.
+};
+
+}       // namespace invictus
+#endif  // CORE_REPLAY_HPP_
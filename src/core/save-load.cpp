@@ -2,27 +2,36 @@
 // Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
 
 #include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <sstream>
 
 #include "area/area.hpp"
 #include "area/tile.hpp"
 #include "codex/codex-tile.hpp"
+#include "core/area-cache.hpp"
 #include "core/core.hpp"
 #include "core/game-manager.hpp"
 #include "core/guru.hpp"
 #include "core/save-load.hpp"
+#include "core/scheduler.hpp"
 #include "entity/buff.hpp"
 #include "entity/item.hpp"
 #include "entity/monster.hpp"
 #include "entity/player.hpp"
+#include "tune/timing.hpp"
 #include "ui/msglog.hpp"
 #include "ui/ui.hpp"
+#include "util/random.hpp"
 
 
 namespace invictus
 {
 
 // Checks for an expected tag in the save file, and aborts if it isn't found.
-void SaveLoad::check_tag(std::ifstream &save_file, SaveTag expected_tag)
+void SaveLoad::check_tag(std::istream &save_file, SaveTag expected_tag)
 {
     SaveTag found_tag = load_data<SaveTag>(save_file);
     if (static_cast<uint32_t>(found_tag) != static_cast<uint32_t>(expected_tag))
@@ -37,8 +46,55 @@ void SaveLoad::check_tag(std::ifstream &save_file, SaveTag expected_tag)
 void SaveLoad::incompatible(unsigned int error_a, unsigned int error_b)
 { core()->guru()->halt("Incompatible saved game", error_a, error_b); }
 
+// Converts an EntityTag ID from an older save file into the current EntityTag.
+EntityTag SaveLoad::legacy_entity_tag(uint16_t legacy_id)
+{
+    switch(legacy_id)
+    {
+        case 1: return EntityTag::ProperNoun;
+        case 2: return EntityTag::PluralName;
+        case 3: return EntityTag::NoA;
+        case 20000: return EntityTag::Unliving;
+        case 20001: return EntityTag::ImmunityBleed;
+        case 20002: return EntityTag::ImmunityPoison;
+        case 21000: return EntityTag::CannotBlock;
+        case 21001: return EntityTag::CannotParry;
+        case 21002: return EntityTag::Passive;
+        case 21003: return EntityTag::Blind;
+        case 23000: return EntityTag::NoDeathMessage;
+        case 33000: return EntityTag::TwoHanded;
+        case 33001: return EntityTag::HandAndAHalf;
+        case 33002: return EntityTag::WeaponRanged;
+        case 33003: return EntityTag::WeaponFinesse;
+        case 33004: return EntityTag::WeaponLight;
+        case 33500: return EntityTag::ArmourLight;
+        case 33501: return EntityTag::ArmourMedium;
+        case 33502: return EntityTag::ArmourHeavy;
+        default: incompatible(SAVE_ERROR_ENTITY_TAG, legacy_id); return EntityTag::ProperNoun;
+    }
+}
+
+// Converts a TileTag ID from an older save file into the current TileTag.
+TileTag SaveLoad::legacy_tile_tag(uint16_t legacy_id)
+{
+    switch(legacy_id)
+    {
+        case 1: return TileTag::BlocksMovement;
+        case 2: return TileTag::BlocksLight;
+        case 3: return TileTag::Immutable;
+        case 100: return TileTag::Changed;
+        case 102: return TileTag::Bloodied;
+        case 103: return TileTag::Open;
+        case 200: return TileTag::StairsUp;
+        case 201: return TileTag::StairsDown;
+        case 202: return TileTag::Openable;
+        case 203: return TileTag::Closeable;
+        default: incompatible(SAVE_ERROR_TILE_TAG, legacy_id); return TileTag::Changed;
+    }
+}
+
 // Loads an Area from disk.
-std::shared_ptr<Area> SaveLoad::load_area(std::ifstream &save_file)
+std::shared_ptr<Area> SaveLoad::load_area(std::istream &save_file, uint32_t subversion)
 {
     check_tag(save_file, SaveTag::AREA);
     uint16_t size_x = load_data<uint16_t>(save_file);
@@ -55,7 +111,15 @@ std::shared_ptr<Area> SaveLoad::load_area(std::ifstream &save_file)
     check_tag(save_file, SaveTag::ENTITIES);
     uint32_t entity_count = load_data<uint32_t>(save_file);
     for (unsigned int i = 0; i < entity_count; i++)
-        area->entities_.push_back(load_entity(save_file));
+    {
+        // Older saves didn't record which slot each Entity was in, so they're just given new ones.
+        if (subversion >= SAVE_SUBVERSION_ENTITY_SLOTS)
+        {
+            uint32_t slot = load_data<uint32_t>(save_file);
+            area->add_entity(load_entity(save_file, subversion), slot);
+        }
+        else area->add_entity(load_entity(save_file, subversion));
+    }
 
     // Load the tile memory.
     check_tag(save_file, SaveTag::TILE_MEMORY);
@@ -64,7 +128,8 @@ std::shared_ptr<Area> SaveLoad::load_area(std::ifstream &save_file)
     // Load the individual tiles.
     check_tag(save_file, SaveTag::TILES);
     for (unsigned int i = 0; i < size_x * size_y; i++)
-        area->tiles_[i] = load_tile(save_file);
+        area->tiles_[i] = load_tile(save_file, subversion);
+    area->rebuild_planes();
 
     return area;
 }
@@ -78,14 +143,14 @@ std::shared_ptr<Area> SaveLoad::load_area_from_file(const std::string &filename)
     uint32_t file_subversion = load_data<uint32_t>(area_file);
     if (file_version != SAVE_VERSION) incompatible(SAVE_ERROR_VERSION, file_version);
     else if (file_subversion > SAVE_SUBVERSION) incompatible(SAVE_ERROR_SUBVERSION, file_subversion);
-    auto new_area = load_area(area_file);
+    auto new_area = load_area(area_file, file_subversion);
     check_tag(area_file, SaveTag::SAVE_EOF);
     area_file.close();
     return new_area;
 }
 
 // Loads a block of memory from disk, decompressing it.
-void SaveLoad::load_blob_compressed(std::ifstream &save_file, char* blob, uint32_t blob_size)
+void SaveLoad::load_blob_compressed(std::istream &save_file, char* blob, uint32_t blob_size)
 {
     check_tag(save_file, SaveTag::COMPRESSED_BLOB);
     uint32_t size_check = load_data<uint32_t>(save_file);
@@ -103,7 +168,7 @@ void SaveLoad::load_blob_compressed(std::ifstream &save_file, char* blob, uint32
 }
 
 // Loads an Entity from disk.
-std::shared_ptr<Entity> SaveLoad::load_entity(std::ifstream &save_file)
+std::shared_ptr<Entity> SaveLoad::load_entity(std::istream &save_file, uint32_t subversion)
 {
     check_tag(save_file, SaveTag::ENTITY);
 
@@ -129,29 +194,35 @@ std::shared_ptr<Entity> SaveLoad::load_entity(std::ifstream &save_file)
     uint32_t prop_f_count = load_data<uint32_t>(save_file);
     for (unsigned int i = 0; i < prop_f_count; i++)
     {
-        EntityProp key = static_cast<EntityProp>(load_data<uint16_t>(save_file));
+        uint16_t key = load_data<uint16_t>(save_file);
         float data = load_data<float>(save_file);
-        entity->entity_properties_f_.insert({key, data});
+        if (key >= static_cast<uint16_t>(EntityProp::_END)) incompatible(SAVE_ERROR_ENTITY, key);
+        entity->set_prop_f(static_cast<EntityProp>(key), data);
     }
     uint32_t prop_i_count = load_data<uint32_t>(save_file);
     for (unsigned int i = 0; i < prop_i_count; i++)
     {
-        EntityProp key = static_cast<EntityProp>(load_data<uint16_t>(save_file));
+        uint16_t key = load_data<uint16_t>(save_file);
         int32_t data = load_data<int32_t>(save_file);
-        entity->entity_properties_i_.insert({key, data});
+        if (key >= static_cast<uint16_t>(EntityProp::_END)) incompatible(SAVE_ERROR_ENTITY, key);
+        entity->set_prop(static_cast<EntityProp>(key), data);
     }
 
-    // Load the EntityTags.
-    uint32_t tag_count = load_data<uint32_t>(save_file);
-    for (unsigned int i = 0; i < tag_count; i++)
-        entity->tags_.insert(static_cast<EntityTag>(load_data<uint16_t>(save_file)));
+    // Load the EntityTags. Older save files stored these as a list of IDs, rather than a bitmask.
+    if (subversion >= SAVE_SUBVERSION_ENTITY_TAG_BITMASK) entity->tags_ = load_data<uint64_t>(save_file);
+    else
+    {
+        uint32_t tag_count = load_data<uint32_t>(save_file);
+        for (unsigned int i = 0; i < tag_count; i++)
+            entity->set_tag(legacy_entity_tag(load_data<uint16_t>(save_file)));
+    }
 
     // Load the inventory.
     check_tag(save_file, SaveTag::INVENTORY);
     uint32_t inv_size = load_data<uint32_t>(save_file);
     for (unsigned int i = 0; i < inv_size; i++)
     {
-        auto new_item = load_entity(save_file);
+        auto new_item = load_entity(save_file, subversion);
         entity->inventory_.push_back(std::dynamic_pointer_cast<Item>(new_item));
     }
 
@@ -160,11 +231,11 @@ std::shared_ptr<Entity> SaveLoad::load_entity(std::ifstream &save_file)
         case EntityType::ITEM: load_item(save_file, std::dynamic_pointer_cast<Item>(entity)); break;
         case EntityType::PLAYER:
             load_player(save_file, std::dynamic_pointer_cast<Player>(entity));
-            load_mobile(save_file, std::dynamic_pointer_cast<Mobile>(entity));
+            load_mobile(save_file, std::dynamic_pointer_cast<Mobile>(entity), subversion);
             break;
         case EntityType::MONSTER:
             load_monster(save_file, std::dynamic_pointer_cast<Monster>(entity));
-            load_mobile(save_file, std::dynamic_pointer_cast<Mobile>(entity));
+            load_mobile(save_file, std::dynamic_pointer_cast<Mobile>(entity), subversion);
             break;
         default: incompatible(SAVE_ERROR_ENTITY, static_cast<uint32_t>(type));
     }
@@ -186,8 +257,8 @@ void SaveLoad::load_game(const std::string &save_folder)
     uint32_t file_subversion = load_data<uint32_t>(save_file);
     if (file_version != SAVE_VERSION) incompatible(SAVE_ERROR_VERSION, file_version);
     else if (file_subversion > SAVE_SUBVERSION) incompatible(SAVE_ERROR_SUBVERSION, file_subversion);
-    std::string area_filename = load_game_manager(save_file);
-    game->player_ = std::dynamic_pointer_cast<Player>(load_entity(save_file));
+    std::string area_filename = load_game_manager(save_file, file_subversion);
+    game->player_ = std::dynamic_pointer_cast<Player>(load_entity(save_file, file_subversion));
     check_tag(save_file, SaveTag::SAVE_EOF);
     save_file.close();
 
@@ -195,21 +266,39 @@ void SaveLoad::load_game(const std::string &save_folder)
 }
 
 // Loads the GameManager class state.
-std::string SaveLoad::load_game_manager(std::ifstream &save_file)
+std::string SaveLoad::load_game_manager(std::istream &save_file, uint32_t subversion)
 {
     auto game_manager = core()->game();
 
     check_tag(save_file, SaveTag::GAME_MANAGER);
     game_manager->game_state_ = static_cast<GameState>(load_data<uint8_t>(save_file));
     game_manager->heartbeat_ = load_data<float>(save_file);
-    game_manager->heartbeat10_ = load_data<float>(save_file);
+
+    // The Scheduler's clock only needs to know how far along it is towards the next tick10() event, which the slower heartbeat used to count.
+    const float heartbeat10 = load_data<float>(save_file);
+    game_manager->scheduler_->clear();
+    game_manager->scheduler_->time_ = std::max(0L, std::lround((heartbeat10 - game_manager->heartbeat_) / TICK_SPEED));
+
+    // Older saves have no game seed, so the levels not yet visited will just be generated from a new one.
+    if (subversion >= SAVE_SUBVERSION_GAME_SEED) game_manager->game_seed_ = load_data<uint32_t>(save_file);
+    else game_manager->game_seed_ = std::random_device()();
+
+    // Likewise, saves without the random number streams' state will have to continue with freshly-seeded ones.
+    if (subversion >= SAVE_SUBVERSION_RNG_STATE)
+    {
+        for (int i = 0; i < static_cast<int>(RNG::_END); i++)
+            for (int j = 0; j < 4; j++)
+                Random::streams_[i].state_[j] = load_data<uint64_t>(save_file);
+        Random::seeded_ = true;
+    }
+    else Random::seed();
     std::string area_filename = load_string(save_file);
     load_ui(save_file);
     return area_filename;
 }
 
 // Loads an Item from disk.
-void SaveLoad::load_item(std::ifstream &save_file, std::shared_ptr<Item> item)
+void SaveLoad::load_item(std::istream &save_file, std::shared_ptr<Item> item)
 {
     check_tag(save_file, SaveTag::ITEM);
     item->item_type_ = static_cast<ItemType>(load_data<uint8_t>(save_file));
@@ -218,7 +307,7 @@ void SaveLoad::load_item(std::ifstream &save_file, std::shared_ptr<Item> item)
 }
 
 // Loads a Mobile from disk.
-void SaveLoad::load_mobile(std::ifstream &save_file, std::shared_ptr<Mobile> mob)
+void SaveLoad::load_mobile(std::istream &save_file, std::shared_ptr<Mobile> mob, uint32_t subversion)
 {
     check_tag(save_file, SaveTag::MOBILE);
 
@@ -245,7 +334,7 @@ void SaveLoad::load_mobile(std::ifstream &save_file, std::shared_ptr<Mobile> mob
     for (unsigned int i = 0; i < equ_size; i++)
     {
         uint8_t gear_exists = load_data<uint8_t>(save_file);
-        if (gear_exists) mob->equipment_.at(i) = std::dynamic_pointer_cast<Item>(load_entity(save_file));
+        if (gear_exists) mob->equipment_.at(i) = std::dynamic_pointer_cast<Item>(load_entity(save_file, subversion));
     }
 
     // Load the buffs, if any.
@@ -261,7 +350,7 @@ void SaveLoad::load_mobile(std::ifstream &save_file, std::shared_ptr<Mobile> mob
 }
 
 // Loads a Monster from disk.
-void SaveLoad::load_monster(std::ifstream &save_file, std::shared_ptr<Monster> monster)
+void SaveLoad::load_monster(std::istream &save_file, std::shared_ptr<Monster> monster)
 {
     check_tag(save_file, SaveTag::MONSTER);
 
@@ -276,22 +365,21 @@ void SaveLoad::load_monster(std::ifstream &save_file, std::shared_ptr<Monster> m
 }
 
 // Loads the message log from disk.
-void SaveLoad::load_msglog(std::ifstream &save_file)
+void SaveLoad::load_msglog(std::istream &save_file)
 {
     auto msglog = core()->game()->ui()->msglog();
     check_tag(save_file, SaveTag::MSGLOG);
     uint32_t size = load_data<uint32_t>(save_file);
     for (unsigned int i = 0; i < size; i++)
     {
-        msglog->output_raw_.push_back(load_string(save_file));
-        msglog->output_raw_fade_.push_back(load_data<uint8_t>(save_file));
+        const uint32_t id = msglog->add(load_string(save_file)).id;
+        if (load_data<uint8_t>(save_file)) msglog->fade_before_ = id + 1;
     }
-    msglog->output_raw_.push_back("{c}Game saved.");
-    msglog->output_raw_fade_.push_back(false);
+    msglog->add("{c}Game saved.");
 }
 
 // Loads a Player from disk.
-void SaveLoad::load_player(std::ifstream &save_file, std::shared_ptr<Player> player)
+void SaveLoad::load_player(std::istream &save_file, std::shared_ptr<Player> player)
 {
     check_tag(save_file, SaveTag::PLAYER);
 
@@ -302,7 +390,7 @@ void SaveLoad::load_player(std::ifstream &save_file, std::shared_ptr<Player> pla
 }
 
 // Loads a string from the save game file.
-std::string SaveLoad::load_string(std::ifstream &save_file)
+std::string SaveLoad::load_string(std::istream &save_file)
 {
     uint32_t len = load_data<uint32_t>(save_file);
     char* data = new char[len];
@@ -313,7 +401,7 @@ std::string SaveLoad::load_string(std::ifstream &save_file)
 }
 
 // Loads a Tile from the save game file.
-Tile SaveLoad::load_tile(std::ifstream &save_file)
+Tile SaveLoad::load_tile(std::istream &save_file, uint32_t subversion)
 {
     TileID tile_id = static_cast<TileID>(load_data<uint16_t>(save_file));
     uint8_t changed = load_data<uint8_t>(save_file);
@@ -325,26 +413,30 @@ Tile SaveLoad::load_tile(std::ifstream &save_file)
     new_tile.ascii_scars_ = load_data<char>(save_file);
     new_tile.colour_ = static_cast<Colour>(load_data<uint8_t>(save_file));
     new_tile.colour_scars_ = static_cast<Colour>(load_data<uint8_t>(save_file));
-    new_tile.name_ = load_string(save_file);
+    new_tile.set_name(load_string(save_file));
 
-    // Load the TileTags.
-    uint32_t tag_count = load_data<uint32_t>(save_file);
-    new_tile.tags_.clear();
-    for (unsigned int i = 0; i < tag_count; i++)
-        new_tile.tags_.insert(static_cast<TileTag>(load_data<uint16_t>(save_file)));
+    // Load the TileTags. Older save files stored these as a list of IDs, rather than a bitmask.
+    if (subversion >= SAVE_SUBVERSION_TILE_BITMASK) new_tile.tags_ = load_data<uint32_t>(save_file);
+    else
+    {
+        uint32_t tag_count = load_data<uint32_t>(save_file);
+        new_tile.tags_ = 0;
+        for (unsigned int i = 0; i < tag_count; i++)
+            new_tile.set_tag(legacy_tile_tag(load_data<uint16_t>(save_file)), false);
+    }
 
     return new_tile;
 }
 
 // Loads the UI elements from the save game file.
-void SaveLoad::load_ui(std::ifstream &save_file)
+void SaveLoad::load_ui(std::istream &save_file)
 {
     check_tag(save_file, SaveTag::UI);
     load_msglog(save_file);
 }
 
 // Saves an Area to disk.
-void SaveLoad::save_area(std::ofstream &save_file, std::shared_ptr<Area> area)
+void SaveLoad::save_area(std::ostream &save_file, std::shared_ptr<Area> area)
 {
     write_tag(save_file, SaveTag::AREA);
     save_data<uint16_t>(save_file, area->size_x_);
@@ -359,8 +451,12 @@ void SaveLoad::save_area(std::ofstream &save_file, std::shared_ptr<Area> area)
     // Save the Entities in this Area.
     write_tag(save_file, SaveTag::ENTITIES);
     save_data<uint32_t>(save_file, area->entities_.size() - 1);
-    for (unsigned int i = 1; i < area->entities_.size(); i++)
-        save_entity(save_file, area->entities_.at(i));
+    for (auto it = area->entities_.begin(); it != area->entities_.end(); ++it)
+    {
+        if (!it.handle().index) continue;   // The player is always in the first slot, and is saved separately.
+        save_data<uint32_t>(save_file, it.handle().index);
+        save_entity(save_file, *it);
+    }
 
     // Save the tile memory. This could probably be compressed someday by storing the long sequences of spaces as some sort of integer tag, but not today.
     write_tag(save_file, SaveTag::TILE_MEMORY);
@@ -372,21 +468,8 @@ void SaveLoad::save_area(std::ofstream &save_file, std::shared_ptr<Area> area)
         save_tile(save_file, area->tiles_[i]);
 }
 
-// Saves an Area to a specific file.
-void SaveLoad::save_area_to_file(const std::string &filename, std::shared_ptr<Area> area)
-{
-    std::ofstream area_file(filename, std::ios::out | std::ios::binary);
-    write_tag(area_file, SaveTag::HEADER_A);
-    write_tag(area_file, SaveTag::HEADER_B);
-    save_data<uint32_t>(area_file, SAVE_VERSION);
-    save_data<uint32_t>(area_file, SAVE_SUBVERSION);
-    save_area(area_file, area);
-    write_tag(area_file, SaveTag::SAVE_EOF);
-    area_file.close();
-}
-
 // Saves a block of memory to disk, in a compressed form.
-void SaveLoad::save_blob_compressed(std::ofstream &save_file, char* blob, uint32_t blob_size)
+void SaveLoad::save_blob_compressed(std::ostream &save_file, char* blob, uint32_t blob_size)
 {
     write_tag(save_file, SaveTag::COMPRESSED_BLOB);
     save_data<uint32_t>(save_file, blob_size);
@@ -416,7 +499,7 @@ void SaveLoad::save_blob_compressed(std::ofstream &save_file, char* blob, uint32
 }
 
 // Saves an Entity to disk.
-void SaveLoad::save_entity(std::ofstream &save_file, std::shared_ptr<Entity> entity)
+void SaveLoad::save_entity(std::ostream &save_file, std::shared_ptr<Entity> entity)
 {
     write_tag(save_file, SaveTag::ENTITY);
 
@@ -429,28 +512,29 @@ void SaveLoad::save_entity(std::ofstream &save_file, std::shared_ptr<Entity> ent
     save_data<uint8_t>(save_file, entity->y_);
 
     // Save the EntityProps.
-    save_data<uint32_t>(save_file, entity->entity_properties_f_.size());
-    for (auto prop_f : entity->entity_properties_f_)
+    const uint16_t prop_count = static_cast<uint16_t>(EntityProp::_END);
+    save_data<uint32_t>(save_file, std::bitset<32>(entity->props_set_f_).count());
+    for (uint16_t i = 0; i < prop_count; i++)
     {
-        save_data<uint16_t>(save_file, static_cast<uint16_t>(prop_f.first));
-        save_data<float>(save_file, prop_f.second);
+        if (!(entity->props_set_f_ & (1u << i))) continue;
+        save_data<uint16_t>(save_file, i);
+        save_data<float>(save_file, entity->props_f_[i]);
     }
-    save_data<uint32_t>(save_file, entity->entity_properties_i_.size());
-    for (auto prop_i : entity->entity_properties_i_)
+    save_data<uint32_t>(save_file, std::bitset<32>(entity->props_set_i_).count());
+    for (uint16_t i = 0; i < prop_count; i++)
     {
-        save_data<uint16_t>(save_file, static_cast<uint16_t>(prop_i.first));
-        save_data<int32_t>(save_file, prop_i.second);
+        if (!(entity->props_set_i_ & (1u << i))) continue;
+        save_data<uint16_t>(save_file, i);
+        save_data<int32_t>(save_file, entity->props_i_[i]);
     }
 
     // Save the EntityTags.
-    save_data<uint32_t>(save_file, entity->tags_.size());
-    for (auto tag : entity->tags_)
-        save_data<uint16_t>(save_file, static_cast<uint16_t>(tag));
+    save_data<uint64_t>(save_file, entity->tags_);
 
     // Save the inventory.
     write_tag(save_file, SaveTag::INVENTORY);
     save_data<uint32_t>(save_file, entity->inventory_.size());
-    for (auto ie : entity->inventory_)
+    for (auto &ie : entity->inventory_)
         save_entity(save_file, ie);
 
     switch(entity->type())
@@ -482,26 +566,32 @@ void SaveLoad::save_game()
     write_tag(save_file, SaveTag::SAVE_EOF);
     save_file.close();
 
-    auto area = core()->game()->area();
-    save_area_to_file(save_dir + "/" + area->filename() + ".dat", core()->game()->area());
+    // The Area itself is serialized right away, but written to disk in the background. Any Monsters waiting to act need their banked ticks brought
+    // up to date first.
+    core()->game()->scheduler()->sync();
+    core()->game()->area_cache()->store(core()->game()->area());
     core()->message("{c}Game saved.");
 }
 
 // Saves the GameManager class state.
-void SaveLoad::save_game_manager(std::ofstream &save_file)
+void SaveLoad::save_game_manager(std::ostream &save_file)
 {
     auto game_manager = core()->game();
 
     write_tag(save_file, SaveTag::GAME_MANAGER);
     save_data<uint8_t>(save_file, static_cast<uint8_t>(game_manager->game_state_));
     save_data<float>(save_file, game_manager->heartbeat_);
-    save_data<float>(save_file, game_manager->heartbeat10_);
+    save_data<float>(save_file, (game_manager->scheduler_->time_ % Scheduler::TICKS_PER_TICK10) * TICK_SPEED + game_manager->heartbeat_);
+    save_data<uint32_t>(save_file, game_manager->game_seed_);
+    for (int i = 0; i < static_cast<int>(RNG::_END); i++)
+        for (int j = 0; j < 4; j++)
+            save_data<uint64_t>(save_file, Random::streams_[i].state_[j]);
     save_string(save_file, game_manager->area_->file_ + std::to_string(game_manager->area_->level_));
     save_ui(save_file);
 }
 
 // Saves an Item to disk.
-void SaveLoad::save_item(std::ofstream &save_file, std::shared_ptr<Item> item)
+void SaveLoad::save_item(std::ostream &save_file, std::shared_ptr<Item> item)
 {
     write_tag(save_file, SaveTag::ITEM);
     save_data<uint8_t>(save_file, static_cast<uint8_t>(item->item_type_));
@@ -510,7 +600,7 @@ void SaveLoad::save_item(std::ofstream &save_file, std::shared_ptr<Item> item)
 }
 
 // Saves a Mobile to disk.
-void SaveLoad::save_mobile(std::ofstream &save_file, std::shared_ptr<Mobile> mob)
+void SaveLoad::save_mobile(std::ostream &save_file, std::shared_ptr<Mobile> mob)
 {
     write_tag(save_file, SaveTag::MOBILE);
 
@@ -533,7 +623,7 @@ void SaveLoad::save_mobile(std::ofstream &save_file, std::shared_ptr<Mobile> mob
 
     // Saves the equipment.
     save_data<uint8_t>(save_file, static_cast<uint8_t>(EquipSlot::_END));
-    for (auto eq : mob->equipment_)
+    for (auto &eq : mob->equipment_)
     {
         if (eq->item_type_ == ItemType::NONE) save_data<uint8_t>(save_file, 0);
         else
@@ -546,7 +636,7 @@ void SaveLoad::save_mobile(std::ofstream &save_file, std::shared_ptr<Mobile> mob
     // Save the buffs, if any.
     write_tag(save_file, SaveTag::BUFFS);
     save_data<uint32_t>(save_file, mob->buffs_.size());
-    for (auto buff : mob->buffs_)
+    for (auto &buff : mob->buffs_)
     {
         save_data<uint16_t>(save_file, static_cast<uint16_t>(buff->get_type()));
         save_data<int>(save_file, buff->get_power());
@@ -555,7 +645,7 @@ void SaveLoad::save_mobile(std::ofstream &save_file, std::shared_ptr<Mobile> mob
 }
 
 // Saves a Monster to disk.
-void SaveLoad::save_monster(std::ofstream &save_file, std::shared_ptr<Monster> monster)
+void SaveLoad::save_monster(std::ostream &save_file, std::shared_ptr<Monster> monster)
 {
     write_tag(save_file, SaveTag::MONSTER);
 
@@ -570,19 +660,20 @@ void SaveLoad::save_monster(std::ofstream &save_file, std::shared_ptr<Monster> m
 }
 
 // Saves the message log to disk.
-void SaveLoad::save_msglog(std::ofstream &save_file)
+void SaveLoad::save_msglog(std::ostream &save_file)
 {
     auto msglog = core()->game()->ui()->msglog();
     write_tag(save_file, SaveTag::MSGLOG);
-    save_data<uint32_t>(save_file, msglog->output_raw_.size());
-    for (unsigned int i = 0; i < msglog->output_raw_.size(); i++)
+    save_data<uint32_t>(save_file, msglog->messages_.size());
+    for (unsigned int i = 0; i < msglog->messages_.size(); i++)
     {
-        save_string(save_file, msglog->output_raw_.at(i));
-        save_data<uint8_t>(save_file, msglog->output_raw_fade_.at(i) ? 1 : 0);
+        const auto &msg = msglog->messages_.at(i);
+        save_string(save_file, msg.text.tagged());
+        save_data<uint8_t>(save_file, msglog->is_faded(msg) ? 1 : 0);
     }
 }
 
-void SaveLoad::save_player(std::ofstream &save_file, std::shared_ptr<Player> player)
+void SaveLoad::save_player(std::ostream &save_file, std::shared_ptr<Player> player)
 {
     write_tag(save_file, SaveTag::PLAYER);
 
@@ -593,14 +684,14 @@ void SaveLoad::save_player(std::ofstream &save_file, std::shared_ptr<Player> pla
 }
 
 // Saves a string to the save game file.
-void SaveLoad::save_string(std::ofstream &save_file, const std::string &str)
+void SaveLoad::save_string(std::ostream &save_file, const std::string &str)
 {
     save_data<uint32_t>(save_file, str.size());
     save_file.write(str.c_str(), str.size());
 }
 
 // Saves a Tile to the save game file.
-void SaveLoad::save_tile(std::ofstream &save_file, Tile tile)
+void SaveLoad::save_tile(std::ostream &save_file, Tile tile)
 {
     save_data<uint16_t>(save_file, static_cast<uint16_t>(tile.id_));
     uint8_t changed = (tile.tag(TileTag::Changed) ? 1 : 0);
@@ -611,23 +702,62 @@ void SaveLoad::save_tile(std::ofstream &save_file, Tile tile)
     save_data<char>(save_file, tile.ascii_scars_);
     save_data<uint8_t>(save_file, static_cast<uint8_t>(tile.colour_));
     save_data<uint8_t>(save_file, static_cast<uint8_t>(tile.colour_scars_));
-    save_string(save_file, tile.name_);
+    save_string(save_file, tile.name(false));
 
     // Save the TileTags.
-    save_data<uint32_t>(save_file, tile.tags_.size());
-    for (auto tag : tile.tags_)
-        save_data<uint16_t>(save_file, static_cast<uint16_t>(tag));
+    save_data<uint32_t>(save_file, tile.tags_);
 }
 
 // Saves the UI elements to the save game file.
-void SaveLoad::save_ui(std::ofstream &save_file)
+void SaveLoad::save_ui(std::ostream &save_file)
 {
     write_tag(save_file, SaveTag::UI);
     save_msglog(save_file);
 }
 
+// Serializes an Area into memory, in the same format used for Area save files.
+std::string SaveLoad::serialize_area(std::shared_ptr<Area> area)
+{
+    std::ostringstream area_data(std::ios::out | std::ios::binary);
+    write_tag(area_data, SaveTag::HEADER_A);
+    write_tag(area_data, SaveTag::HEADER_B);
+    save_data<uint32_t>(area_data, SAVE_VERSION);
+    save_data<uint32_t>(area_data, SAVE_SUBVERSION);
+    save_area(area_data, area);
+    write_tag(area_data, SaveTag::SAVE_EOF);
+    return area_data.str();
+}
+
+// Generates a checksum of the current game world's state, not counting the UI, to check that replays match.
+uint64_t SaveLoad::state_checksum()
+{
+    auto game = core()->game();
+    if (!game || !game->area_ || !game->player_) return 0;
+
+    // The message log is left out, as it fades old messages based on the real-world time.
+    std::ostringstream state(std::ios::out | std::ios::binary);
+    game->scheduler_->sync();
+    save_data<float>(state, game->heartbeat_);
+    save_data<uint64_t>(state, game->scheduler_->time_);
+    save_data<uint32_t>(state, game->game_seed_);
+    for (int i = 0; i < static_cast<int>(RNG::_END); i++)
+        for (int j = 0; j < 4; j++)
+            save_data<uint64_t>(state, Random::streams_[i].state_[j]);
+    save_entity(state, game->player_);
+    save_area(state, game->area_);
+
+    // A simple 64-bit FNV-1a hash of the serialized state.
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto ch : state.str())
+    {
+        hash ^= static_cast<uint8_t>(ch);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 // Writes a save tag to the save game file.
-void SaveLoad::write_tag(std::ofstream &save_file, SaveTag tag)
+void SaveLoad::write_tag(std::ostream &save_file, SaveTag tag)
 { save_data<uint32_t>(save_file, static_cast<uint32_t>(tag)); }
 
 }   // namespace invictus
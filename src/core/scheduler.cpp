@@ -0,0 +1,173 @@
+// core/scheduler.cpp -- The Scheduler keeps track of when each Mobile in the current Area is next due to do something, so that the passage of time can skip
+// straight from one event to the next, rather than stepping through every tick.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#include <algorithm>
+
+#include "area/area.hpp"
+#include "core/core.hpp"
+#include "core/game-manager.hpp"
+#include "core/scheduler.hpp"
+#include "entity/monster.hpp"
+#include "tune/timing.hpp"
+
+
+namespace invictus
+{
+
+// Constructor, sets default values.
+Scheduler::Scheduler() : check_sleepers_(false), time_(0) { }
+
+// Discards every scheduled event, and resets the clock for a new game.
+void Scheduler::clear()
+{
+    area_.reset();
+    check_sleepers_ = false;
+    queue_.clear();
+    sleepers_.clear();
+    time_ = 0;
+}
+
+// Comparison function for the event queue, which puts the earliest event at the top.
+bool Scheduler::later(const Event &a, const Event &b)
+{
+    if (a.due != b.due) return a.due > b.due;
+    if (a.type != b.type) return a.type > b.type;
+    return a.order > b.order;
+}
+
+// Lets the Scheduler know that a Mobile has woken up, so that it can be given its first action.
+void Scheduler::mobile_woke() { check_sleepers_ = true; }
+
+// Adds an event to the queue.
+void Scheduler::push(Event event)
+{
+    queue_.push_back(event);
+    std::push_heap(queue_.begin(), queue_.end(), later);
+}
+
+// Schedules events for every Mobile in a newly-entered Area.
+void Scheduler::rebuild(std::shared_ptr<Area> area)
+{
+    sync();     // Any Monsters left waiting in the previous Area keep the ticks they banked while we were there.
+    queue_.clear();
+    sleepers_.clear();
+    check_sleepers_ = false;
+    area_ = area;
+
+    // Every Mobile's tick10() events stay in step with the same clock, as they always have.
+    const uint64_t next_tick10 = (time_ / TICKS_PER_TICK10 + 1) * TICKS_PER_TICK10;
+    auto actors = area->actors();
+    for (unsigned int i = 0; i < actors->size(); i++)
+    {
+        auto mob = actors->at(i);
+        push({next_tick10, EventType::TICK10, i, 0, mob});
+        if (mob->type() == EntityType::MONSTER) schedule_act(std::static_pointer_cast<Monster>(mob), i);
+    }
+}
+
+// Processes every event due within the specified number of ticks, then moves the clock forward.
+void Scheduler::run(uint32_t ticks)
+{
+    auto game = core()->game();
+    auto area = game->area();
+    if (!area) return;
+    if (area != area_.lock()) rebuild(area);
+    if (check_sleepers_) wake_sleepers();
+
+    const uint64_t end = time_ + ticks;
+    while (queue_.size() && queue_.front().due <= end)
+    {
+        if (game->game_state() != GameState::DUNGEON) break;    // If the game state changes, just stop processing events.
+        std::pop_heap(queue_.begin(), queue_.end(), later);
+        Event event = queue_.back();
+        queue_.pop_back();
+        time_ = event.due;
+
+        // Dead Mobiles don't do anything, so their events are just dropped.
+        auto mob = event.mob.lock();
+        if (!mob || mob->is_dead()) continue;
+
+        if (event.type == EventType::TICK10)
+        {
+            mob->tick10(mob);
+            event.due += TICKS_PER_TICK10;
+            push(event);
+        }
+        else
+        {
+            // Credit the Monster with the ticks it spent waiting, one at a time, exactly as if it had been ticked on each of them.
+            auto monster = std::static_pointer_cast<Monster>(mob);
+            for (uint64_t t = event.banked_to + 1; t < event.due; t++)
+                monster->add_banked_ticks(TICK_SPEED);
+            monster->tick(monster);
+            schedule_act(monster, event.order);
+        }
+        if (check_sleepers_) wake_sleepers();
+    }
+    time_ = std::max(time_, end);
+}
+
+// Schedules a Monster's next action, or puts it to one side if it's asleep.
+void Scheduler::schedule_act(std::shared_ptr<Monster> monster, uint32_t order)
+{
+    if (monster->is_dead()) return;
+    if (!monster->is_awake())
+    {
+        monster->clear_banked_ticks();
+        sleepers_.push_back({monster, order});
+        return;
+    }
+
+    // Passive Monsters never act at all, so there's nothing to schedule.
+    if (monster->tag(EntityTag::Passive))
+    {
+        monster->clear_banked_ticks();
+        return;
+    }
+
+    // Work out how many ticks it'll take to bank enough time to move or attack, adding them up the same way Monster::tick() does.
+    const float needed = std::min(monster->movement_speed(), monster->attack_speed());
+    float banked = monster->banked_ticks();
+    uint32_t delay = 0;
+    do
+    {
+        banked += TICK_SPEED;
+        delay++;
+    } while (banked < needed && delay < MAX_ACT_DELAY);
+    push({time_ + delay, EventType::ACT, order, time_, monster});
+}
+
+// Brings every waiting Monster's banked ticks up to date, so that the Area can be saved.
+void Scheduler::sync()
+{
+    for (auto &event : queue_)
+    {
+        if (event.type != EventType::ACT) continue;
+        auto mob = event.mob.lock();
+        if (!mob) continue;
+        auto monster = std::static_pointer_cast<Monster>(mob);
+        const uint64_t credit_to = std::min(time_, event.due - 1);
+        for (uint64_t t = event.banked_to + 1; t <= credit_to; t++)
+            monster->add_banked_ticks(TICK_SPEED);
+        event.banked_to = std::max(event.banked_to, credit_to);
+    }
+}
+
+// Retrieves the current time, in ticks.
+uint64_t Scheduler::time() const { return time_; }
+
+// Schedules actions for any sleeping Monsters which have since woken up.
+void Scheduler::wake_sleepers()
+{
+    check_sleepers_ = false;
+    auto sleepers = std::move(sleepers_);
+    sleepers_.clear();
+    for (auto &sleeper : sleepers)
+    {
+        auto monster = sleeper.first.lock();
+        if (monster) schedule_act(monster, sleeper.second);    // Anything still asleep just goes straight back on the list.
+    }
+}
+
+}   // namespace invictus
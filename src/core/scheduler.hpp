@@ -0,0 +1,66 @@
+// core/scheduler.hpp -- The Scheduler keeps track of when each Mobile in the current Area is next due to do something, so that the passage of time can skip
+// straight from one event to the next, rather than stepping through every tick.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef CORE_SCHEDULER_HPP_
+#define CORE_SCHEDULER_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+namespace invictus
+{
+
+class Area;     // defined in area/area.hpp
+class Mobile;   // defined in entity/mobile.hpp
+class Monster;  // defined in entity/monster.hpp
+
+
+// The types of event which can be scheduled. When events are due on the same tick, actions come before the slower tick10() events.
+enum class EventType : uint8_t { ACT, TICK10 };
+
+
+class Scheduler
+{
+public:
+                Scheduler();    // Constructor, sets default values.
+    void        clear();        // Discards every scheduled event, and resets the clock for a new game.
+    void        mobile_woke();  // Lets the Scheduler know that a Mobile has woken up, so that it can be given its first action.
+    void        run(uint32_t ticks);    // Processes every event due within the specified number of ticks, then moves the clock forward.
+    void        sync();         // Brings every waiting Monster's banked ticks up to date, so that the Area can be saved.
+    uint64_t    time() const;   // Retrieves the current time, in ticks.
+
+private:
+    static constexpr uint32_t   TICKS_PER_TICK10 =  10;     // How many ticks pass between each tick10() event.
+    static constexpr uint32_t   MAX_ACT_DELAY =     10000;  // The furthest ahead a Monster's next action can be scheduled.
+
+    struct Event
+    {
+        uint64_t    due;        // The tick this event is due on.
+        EventType   type;       // The type of event.
+        uint32_t    order;      // The Mobile's position in the Area's list of actors, so Mobiles due at the same time act in a consistent order.
+        uint64_t    banked_to;  // For actions, the tick up to which the Monster's banked ticks have been credited.
+        std::weak_ptr<Mobile>   mob;    // The Mobile this event belongs to.
+    };
+
+    static bool later(const Event &a, const Event &b);  // Comparison function for the event queue, which puts the earliest event at the top.
+
+    void        push(Event event);  // Adds an event to the queue.
+    void        rebuild(std::shared_ptr<Area> area);    // Schedules events for every Mobile in a newly-entered Area.
+    void        schedule_act(std::shared_ptr<Monster> monster, uint32_t order); // Schedules a Monster's next action, or puts it to one side if it's asleep.
+    void        wake_sleepers();    // Schedules actions for any sleeping Monsters which have since woken up.
+
+    std::weak_ptr<Area> area_;      // The Area the events are scheduled for.
+    bool        check_sleepers_;    // Has a Mobile woken up since the sleeping Monsters were last checked?
+    std::vector<Event>  queue_;     // The scheduled events, kept as a heap.
+    std::vector<std::pair<std::weak_ptr<Monster>, uint32_t>>    sleepers_;  // Sleeping Monsters, which have no actions scheduled, and their list order.
+    uint64_t    time_;              // The current time, in ticks.
+
+friend class SaveLoad;
+};
+
+}       // namespace invictus
+#endif  // CORE_SCHEDULER_HPP_
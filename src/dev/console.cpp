@@ -4,6 +4,7 @@
 #include <cstdlib>
 #include <vector>
 
+#include "core/area-cache.hpp"
 #include "core/core.hpp"
 #include "core/game-manager.hpp"
 #include "dev/console.hpp"
@@ -37,7 +38,8 @@ void DevConsole::process_command(std::string cmd)
 {
     std::vector<std::string> words = StrX::string_explode(cmd, " ");
 
-    if (words.at(0) == "qns")
+    if (words.at(0) == "cache") core()->message("{C}Area cache: " + core()->game()->area_cache()->stats());
+    else if (words.at(0) == "qns")
     {
         core()->cleanup();
         exit(EXIT_SUCCESS);
@@ -0,0 +1,171 @@
+// dev/fov-benchmark.cpp -- Accessible by launching the game with the `-fov-benchmark` parameter.
+// Compares the speed and results of the shadowcasting code against the older floating-point implementation, on freshly generated dungeon maps.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "area/area.hpp"
+#include "area/gen-dungeon.hpp"
+#include "area/shadowcast.hpp"
+#include "area/tile.hpp"
+#include "core/core.hpp"
+#include "core/guru.hpp"
+#include "dev/fov-benchmark.hpp"
+#include "terminal/terminal.hpp"
+
+
+namespace invictus
+{
+
+int DevFovBenchmark::reference_multipliers_[4][8] = {
+    {1, 0, 0, -1, -1, 0, 0, 1},
+    {0, 1, -1, 0, 0, -1, 1, 0},
+    {0, 1, 1, 0, 0, -1, -1, 0},
+    {1, 0, 0, 1, -1, 0, 0, -1}
+};
+
+// The old shadowcasting code.
+void DevFovBenchmark::reference_calc_fov(Area* area, bool* visible, unsigned int x, unsigned int y, unsigned int radius)
+{
+    for (unsigned int i = 0; i < 8; i++)
+        reference_cast_light(area, visible, x, y, radius, 1, 1.0, 0.0, reference_multipliers_[0][i], reference_multipliers_[1][i],
+            reference_multipliers_[2][i], reference_multipliers_[3][i]);
+}
+
+// Recursive part of the above. This is kept exactly as it was, other than writing to a separate array, and reading opacity from the Tiles directly as
+// Area::is_opaque() used to.
+void DevFovBenchmark::reference_cast_light(Area* area, bool* visible, unsigned int x, unsigned int y, unsigned int radius, unsigned int row,
+    float start_slope, float end_slope, unsigned int xx, unsigned int xy, unsigned int yx, unsigned int yy)
+{
+    if (start_slope < end_slope) return;
+    float next_start_slope = start_slope;
+
+    for (unsigned int i = row; i <= radius; i++)
+    {
+        bool blocked = false;
+        for (int dx = -i, dy = -i; dx <= 0; dx++)
+        {
+            float l_slope = (dx - 0.5) / (dy + 0.5);
+            float r_slope = (dx + 0.5) / (dy - 0.5);
+            if (start_slope < r_slope) continue;
+            else if (end_slope > l_slope) break;
+
+            int sax = dx * xx + dy * xy;
+            int say = dx * yx + dy * yy;
+            if ((sax < 0 && static_cast<unsigned int>(std::abs(sax)) > x) || (say < 0 && static_cast<unsigned int>(std::abs(say)) > y)) continue;
+            unsigned int ax = x + sax;
+            unsigned int ay = y + say;
+            if (ax >= static_cast<unsigned int>(area->width()) || ay >= static_cast<unsigned int>(area->height())) continue;
+
+            unsigned int radius2 = radius * radius;
+            if (static_cast<unsigned int>(dx * dx + dy * dy) < radius2) visible[ax + (ay * area->width())] = true;
+
+            if (blocked)
+            {
+                if (area->tile(ax, ay)->tag(TileTag::BlocksLight))
+                {
+                    next_start_slope = r_slope;
+                    continue;
+                }
+                else
+                {
+                    blocked = false;
+                    start_slope = next_start_slope;
+                }
+            }
+            else if (area->tile(ax, ay)->tag(TileTag::BlocksLight))
+            {
+                blocked = true;
+                next_start_slope = r_slope;
+                reference_cast_light(area, visible, x, y, radius, i + 1, start_slope, l_slope, xx, xy, yx, yy);
+            }
+        }
+        if (blocked) break;
+    }
+}
+
+// Runs the benchmark, and displays the results.
+void DevFovBenchmark::run()
+{
+    constexpr int   BENCHMARK_MAPS =        20;     // How many dungeon maps to generate for testing.
+    constexpr int   BENCHMARK_MAP_SIZE =    50;     // The width and height of each map, the same as the game's own dungeon levels.
+    constexpr int   BENCHMARK_RADII[] = { 3, 6, 9, 12 };    // The field-of-view radii to test on each map.
+
+    auto terminal = core()->terminal();
+    terminal->cls();
+    terminal->print("{W}Generating " + std::to_string(BENCHMARK_MAPS) + " maps and running field-of-view calculations, please wait...", 1, 1);
+    terminal->flip();
+
+    const int map_tiles = BENCHMARK_MAP_SIZE * BENCHMARK_MAP_SIZE;
+    bool* new_array = new bool[map_tiles];
+    bool* old_array = new bool[map_tiles];
+    double new_time = 0, old_time = 0;
+    unsigned int calculations = 0, mismatches = 0, mismatched_tiles = 0;
+
+    for (int map = 0; map < BENCHMARK_MAPS; map++)
+    {
+        auto area = std::make_shared<Area>(BENCHMARK_MAP_SIZE, BENCHMARK_MAP_SIZE);
+        auto generator = std::make_unique<DungeonGenerator>(area, map);
+        generator->generate();
+        auto opacity = area->opacity_plane();
+
+        for (auto radius : BENCHMARK_RADII)
+        {
+            for (int y = 0; y < BENCHMARK_MAP_SIZE; y++)
+            {
+                for (int x = 0; x < BENCHMARK_MAP_SIZE; x++)
+                {
+                    if (area->tile(x, y)->tag(TileTag::BlocksMovement)) continue;
+                    std::memset(new_array, 0, map_tiles);
+                    std::memset(old_array, 0, map_tiles);
+
+                    auto start = std::chrono::steady_clock::now();
+                    Shadowcast::calc_fov(opacity, new_array, x, y, radius);
+                    auto middle = std::chrono::steady_clock::now();
+                    reference_calc_fov(area.get(), old_array, x, y, radius);
+                    auto end = std::chrono::steady_clock::now();
+                    new_time += std::chrono::duration<double, std::micro>(middle - start).count();
+                    old_time += std::chrono::duration<double, std::micro>(end - middle).count();
+                    calculations++;
+
+                    unsigned int different = 0;
+                    for (int i = 0; i < map_tiles; i++)
+                        if (new_array[i] != old_array[i]) different++;
+                    if (different)
+                    {
+                        mismatches++;
+                        mismatched_tiles += different;
+                    }
+                }
+            }
+        }
+        area->cleanup();
+    }
+    delete[] new_array;
+    delete[] old_array;
+
+    const std::string old_avg = std::to_string(calculations ? old_time / calculations : 0);
+    const std::string new_avg = std::to_string(calculations ? new_time / calculations : 0);
+    const std::string speedup = std::to_string(new_time > 0 ? old_time / new_time : 0);
+    core()->guru()->log("FoV benchmark: " + std::to_string(calculations) + " calculations, old " + old_avg + "us, new " + new_avg + "us (" + speedup +
+        "x), " + std::to_string(mismatches) + " mismatched results.");
+
+    terminal->cls();
+    terminal->print("{W}Field-of-view benchmark complete!", 1, 1);
+    terminal->print("{w}Calculations per implementation: {C}" + std::to_string(calculations), 1, 3);
+    terminal->print("{w}Old floating-point shadowcasting: {C}" + old_avg + " {w}microseconds average", 1, 4);
+    terminal->print("{w}New integer shadowcasting: {C}" + new_avg + " {w}microseconds average", 1, 5);
+    terminal->print("{w}Speed-up: {C}" + speedup + "x", 1, 6);
+    terminal->print("{w}Calculations with different results: " + std::string(mismatches ? "{Y}" : "{G}") + std::to_string(mismatches) +
+        " {w}(" + std::to_string(mismatched_tiles) + " tiles in total)", 1, 7);
+    terminal->print("{W}Please press any key to exit.", 1, 9);
+    terminal->flip();
+    terminal->get_key();
+}
+
+}   // namespace invictus
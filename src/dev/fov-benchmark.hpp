@@ -0,0 +1,28 @@
+// dev/fov-benchmark.hpp -- Accessible by launching the game with the `-fov-benchmark` parameter.
+// Compares the speed and results of the shadowcasting code against the older floating-point implementation, on freshly generated dungeon maps.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef DEV_FOV_BENCHMARK_HPP_
+#define DEV_FOV_BENCHMARK_HPP_
+
+namespace invictus
+{
+
+class Area; // defined in area/area.hpp
+
+
+class DevFovBenchmark
+{
+public:
+    static void run();  // Runs the benchmark, and displays the results.
+
+private:
+    static void reference_calc_fov(Area* area, bool* visible, unsigned int x, unsigned int y, unsigned int radius);  // The old shadowcasting code.
+    static void reference_cast_light(Area* area, bool* visible, unsigned int x, unsigned int y, unsigned int radius, unsigned int row,
+        float start_slope, float end_slope, unsigned int xx, unsigned int xy, unsigned int yx, unsigned int yy);    // Recursive part of the above.
+
+    static int  reference_multipliers_[4][8];   // Octant transforms used by the old shadowcasting code.
+};
+
+}       // namespace invictus
+#endif  // DEV_FOV_BENCHMARK_HPP_
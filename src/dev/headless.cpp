@@ -0,0 +1,235 @@
+// dev/headless.cpp -- Accessible by launching the game with the `-headless` parameter (or `-headless=<turns>`), or `-replay <file>`.
+// Runs the game without Curses, with a simple bot or a recorded replay playing it as fast as possible, then reports the speed of the game loop and its
+// subsystems.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#include <cstdlib>
+#include <iostream>
+
+#include "area/area.hpp"
+#include "area/bitplane.hpp"
+#include "area/pathfind.hpp"
+#include "area/tile.hpp"
+#include "core/core.hpp"
+#include "core/game-manager.hpp"
+#include "core/guru.hpp"
+#include "core/replay.hpp"
+#include "dev/headless.hpp"
+#include "entity/player.hpp"
+#include "terminal/terminal.hpp"
+#include "tune/area-generation.hpp"
+#include "tune/headless.hpp"
+#include "util/filex.hpp"
+#include "util/random.hpp"
+#include "util/strx.hpp"
+
+
+namespace invictus
+{
+
+/*****************************
+ * SCOPE SUBCLASS DEFINITION *
+ *****************************/
+
+// Starts timing a section of code.
+DevHeadless::Scope::Scope(HeadlessTimer section) : section_(section)
+{ if (active_) start_ = std::chrono::steady_clock::now(); }
+
+// Adds the elapsed time to the section's total.
+DevHeadless::Scope::~Scope()
+{
+    if (!active_) return;
+    timers_[static_cast<int>(section_)] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+}
+
+
+/********************************
+ * DEVHEADLESS CLASS DEFINITION *
+ ********************************/
+
+bool        DevHeadless::active_ = false;       // Is headless mode running?
+bool        DevHeadless::descending_ = true;    // Is the bot heading down the stairs, rather than up?
+std::string DevHeadless::finish_reason_;        // Why the run ended, if it was ended by the bot or by running out of replay data.
+int         DevHeadless::last_x_ = -1;          // The player's position on the previous turn, to check if the bot is stuck.
+int         DevHeadless::last_y_ = -1;
+int         DevHeadless::max_turns_ = 0;        // How many turns the bot should play for.
+bool        DevHeadless::replaying_ = false;    // Is a replay being played back, rather than the bot playing?
+std::chrono::steady_clock::time_point   DevHeadless::start_time_;   // When the run started.
+int         DevHeadless::stair_trips_ = 0;      // How many times the bot has taken the stairs.
+int         DevHeadless::stuck_turns_ = 0;      // How many turns in a row the bot has failed to move.
+uint64_t    DevHeadless::timers_[static_cast<int>(HeadlessTimer::_END)] = { };  // The total time spent in each timed section, in nanoseconds.
+int         DevHeadless::turns_ = 0;            // How many turns the bot has played (or keypresses have been replayed) so far.
+int         DevHeadless::wander_turns_ = 0;     // How many more turns the bot should wander randomly, after getting stuck.
+
+// Checks if headless mode is running.
+bool DevHeadless::active() { return active_; }
+
+// Decides on the bot's next keypress.
+int DevHeadless::bot_key()
+{
+    auto game = core()->game();
+    if (game->game_state() != GameState::DUNGEON) finish("The player has died.");
+    if (turns_ >= max_turns_) finish("Completed " + StrX::intostr_pretty(max_turns_) + " turns.");
+    turns_++;
+
+    // The bot is here to exercise the game loop, not to win, so it just heals back to full every turn and keeps on going.
+    auto player = game->player();
+    auto area = game->area();
+    player->set_hp(player->hp(true));
+    const int px = player->x(), py = player->y();
+    if (px == last_x_ && py == last_y_) stuck_turns_++;
+    else stuck_turns_ = 0;
+    last_x_ = px;
+    last_y_ = py;
+
+    // Attack anything standing right next to us, unless it's out of reach (such as a druj still lying in its tomb).
+    for (int dx = -1; dx <= 1; dx++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            const int x = px + dx, y = py + dy;
+            if ((!dx && !dy) || x < 0 || y < 0 || x >= area->width() || y >= area->height() || area->impassable_plane()->get(x, y)) continue;
+            for (auto &entity : area->entities_at(x, y))
+            {
+                if (entity->type() != EntityType::MONSTER || !entity->blocks_tile(x, y)) continue;    // Corpses don't block tiles, so we can ignore those.
+                stuck_turns_ = 0;
+                return direction_key(dx, dy);
+            }
+        }
+    }
+
+    // Head down to the bottom of the dungeon, then back up to the top, and so on.
+    if (descending_ && area->level() >= DUNGEON_LEVELS) descending_ = false;
+    else if (!descending_ && area->level() <= 1) descending_ = true;
+    const TileTag stairs_tag = (descending_ ? TileTag::StairsDown : TileTag::StairsUp);
+    if (area->tile(px, py)->tag(stairs_tag))
+    {
+        stair_trips_++;
+        return (descending_ ? '>' : '<');
+    }
+
+    if (stuck_turns_ >= HEADLESS_STUCK_TURNS)
+    {
+        stuck_turns_ = 0;
+        wander_turns_ = HEADLESS_STUCK_TURNS;
+    }
+    if (!wander_turns_)
+    {
+        auto stairs = area->find_tile_tag(stairs_tag);
+        auto path = Pathfind(PathfindMode::PATHFIND_PLAYER, px, py, stairs.first, stairs.second).pathfind();
+        if (path.size()) return direction_key(path.at(0).first - px, path.at(0).second - py);
+        wander_turns_ = HEADLESS_STUCK_TURNS;
+    }
+
+    wander_turns_--;
+    const int dx = static_cast<int>(Random::rng(0, 2)) - 1, dy = static_cast<int>(Random::rng(0, 2)) - 1;
+    if (!dx && !dy) return ',';
+    return direction_key(dx, dy);
+}
+
+// Converts a direction into a movement key.
+int DevHeadless::direction_key(int dx, int dy)
+{
+    if (dx < 0 && dy < 0) return 'y';
+    else if (dx > 0 && dy < 0) return 'u';
+    else if (dx < 0 && dy > 0) return 'b';
+    else if (dx > 0 && dy > 0) return 'n';
+    else if (dx < 0) return 'h';
+    else if (dx > 0) return 'l';
+    else if (dy < 0) return 'k';
+    else if (dy > 0) return 'j';
+    else return ',';
+}
+
+// Ends the run early, and exits.
+void DevHeadless::finish(const std::string &reason)
+{
+    finish_reason_ = reason;
+    core()->cleanup();
+    exit(EXIT_SUCCESS);
+}
+
+// Checks a command-line parameter for headless mode, and returns the number of turns to run, or 0.
+int DevHeadless::parse_turns(const std::string &param)
+{
+    if (param == "-headless") return HEADLESS_DEFAULT_TURNS;
+    if (param.size() <= 10 || param.substr(0, 10) != "-headless=") return 0;
+    const std::string turns = param.substr(10);
+    if (!StrX::is_number(turns)) return 0;
+    return std::atoi(turns.c_str());
+}
+
+// Plays back a recorded replay file, as fast as possible.
+void DevHeadless::replay(const std::string &filename)
+{
+    if (!Replay::load(filename))
+    {
+        core()->guru()->halt("Could not load replay file: " + filename);
+        return;
+    }
+
+    // Replays are played in their own save folder too, as they start a new game, which would erase any existing saved game.
+    FileX::make_dir("userdata/replay");
+    auto game = core()->game();
+    game->set_save_folder("userdata/replay");
+
+    active_ = replaying_ = true;
+    start_time_ = std::chrono::steady_clock::now();
+    core()->terminal()->set_key_source(replay_key);
+    game->set_game_state(GameState::NEW_GAME);
+    game->game_loop();
+}
+
+// Retrieves the next keypress from the replay being played back.
+int DevHeadless::replay_key()
+{
+    int key = 0;
+    if (!Replay::next_key(&key)) finish("Reached the end of the recorded keypresses.");
+    turns_++;
+    return key;
+}
+
+// Reports the results of the run, if headless mode is running. This is called during cleanup, however the run ends.
+void DevHeadless::report()
+{
+    if (!active_) return;
+    active_ = false;
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    const std::string unit = (replaying_ ? "keypresses" : "turns");
+    const std::string turns_per_sec = StrX::ftos(seconds > 0 ? turns_ / seconds : 0);
+    const std::string section_names[] = { "Player input", "- Stairs and level changes", "World ticks (AI)", "Rendering", "- Field of view" };
+
+    std::cout << (replaying_ ? "Replay finished: " : "Headless run finished: ") << (finish_reason_.size() ? finish_reason_ : "The game was closed.") <<
+        std::endl;
+    std::cout << StrX::intostr_pretty(turns_) << " " << unit << " in " << StrX::ftos(seconds) << " seconds (" << turns_per_sec << " " << unit << "/sec)";
+    if (replaying_) std::cout << "." << std::endl << Replay::verify_result() << std::endl;
+    else std::cout << ", " << stair_trips_ << " trips on the stairs." << std::endl;
+    for (int i = 0; i < static_cast<int>(HeadlessTimer::_END); i++)
+    {
+        const double ms = timers_[i] / 1000000.0;
+        const double us_per_turn = (turns_ ? timers_[i] / 1000.0 / turns_ : 0);
+        std::cout << "  " << StrX::pad_string(section_names[i] + ":", 30) << StrX::pad_string(StrX::ftos(ms) + " ms", 16) << StrX::ftos(us_per_turn) <<
+            " us/" << (replaying_ ? "key" : "turn") << std::endl;
+    }
+    core()->guru()->log((replaying_ ? "Replay: " : "Headless run: ") + std::to_string(turns_) + " " + unit + " in " + StrX::ftos(seconds) +
+        " seconds (" + turns_per_sec + " " + unit + "/sec).");
+}
+
+// Sets up a new game, and lets the bot play it for the specified number of turns.
+void DevHeadless::run(int turns)
+{
+    // The bot plays in its own save folder, so it can't clobber the player's saved game.
+    FileX::make_dir("userdata/headless");
+    auto game = core()->game();
+    game->set_save_folder("userdata/headless");
+
+    core()->guru()->log("Starting headless run for " + std::to_string(turns) + " turns.");
+    active_ = true;
+    max_turns_ = turns;
+    start_time_ = std::chrono::steady_clock::now();
+    core()->terminal()->set_key_source(bot_key);
+    game->set_game_state(GameState::NEW_GAME);
+    game->game_loop();
+}
+
+}   // namespace invictus
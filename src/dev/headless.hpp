@@ -0,0 +1,63 @@
+// dev/headless.hpp -- Accessible by launching the game with the `-headless` parameter (or `-headless=<turns>`), or `-replay <file>`.
+// Runs the game without Curses, with a simple bot or a recorded replay playing it as fast as possible, then reports the speed of the game loop and its
+// subsystems.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef DEV_HEADLESS_HPP_
+#define DEV_HEADLESS_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+
+namespace invictus
+{
+
+// The sections of the game loop which are timed in headless mode.
+enum class HeadlessTimer : uint8_t { INPUT, STAIRS, TICK, RENDER, FOV, _END };
+
+
+class DevHeadless
+{
+public:
+    // Times a section of code for as long as it exists, if headless mode is running.
+    class Scope
+    {
+    public:
+                Scope(HeadlessTimer section);   // Starts timing a section of code.
+                ~Scope();   // Adds the elapsed time to the section's total.
+
+    private:
+        HeadlessTimer   section_;   // The section of code being timed.
+        std::chrono::steady_clock::time_point   start_; // When this section started running.
+    };
+
+    static bool active();   // Checks if headless mode is running.
+    static int  parse_turns(const std::string &param);  // Checks a command-line parameter for headless mode, and returns the number of turns to run, or 0.
+    static void replay(const std::string &filename);    // Plays back a recorded replay file, as fast as possible.
+    static void report();   // Reports the results of the run, if headless mode is running. This is called during cleanup, however the run ends.
+    static void run(int turns); // Sets up a new game, and lets the bot play it for the specified number of turns.
+
+private:
+    static int  bot_key();  // Decides on the bot's next keypress.
+    static int  direction_key(int dx, int dy);  // Converts a direction into a movement key.
+    static void finish(const std::string &reason);  // Ends the run early, and exits.
+    static int  replay_key();   // Retrieves the next keypress from the replay being played back.
+
+    static bool     active_;        // Is headless mode running?
+    static bool     descending_;    // Is the bot heading down the stairs, rather than up?
+    static std::string  finish_reason_; // Why the run ended, if it was ended by the bot or by running out of replay data.
+    static int      last_x_, last_y_;   // The player's position on the previous turn, to check if the bot is stuck.
+    static int      max_turns_;     // How many turns the bot should play for.
+    static bool     replaying_;     // Is a replay being played back, rather than the bot playing?
+    static std::chrono::steady_clock::time_point    start_time_;    // When the run started.
+    static int      stair_trips_;   // How many times the bot has taken the stairs.
+    static int      stuck_turns_;   // How many turns in a row the bot has failed to move.
+    static uint64_t timers_[static_cast<int>(HeadlessTimer::_END)];    // The total time spent in each timed section, in nanoseconds.
+    static int      turns_;         // How many turns the bot has played (or keypresses have been replayed) so far.
+    static int      wander_turns_;  // How many more turns the bot should wander randomly, after getting stuck.
+};
+
+}       // namespace invictus
+#endif  // DEV_HEADLESS_HPP_
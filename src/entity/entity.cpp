@@ -17,20 +17,17 @@ namespace invictus
 {
 
 // Constructor, creates a new Entity with default values.
-Entity::Entity() : ascii_(ASCII_UNKNOWN), colour_(Colour::WHITE), name_("entity"), x_(0), y_(0) { }
+Entity::Entity() : area_(nullptr), ascii_(ASCII_UNKNOWN), colour_(Colour::WHITE), name_("entity"), props_f_{}, props_i_{}, props_set_f_(0), props_set_i_(0),
+    tags_(0), x_(0), y_(0) { }
 
 // Gets the ASCII character representing this Entity.
 char Entity::ascii() const { return ascii_; }
 
 // Clears an EntityTag from this Entity.
-void Entity::clear_tag(EntityTag the_tag)
-{
-    if (!(tags_.count(the_tag) > 0)) return;
-    tags_.erase(the_tag);
-}
+void Entity::clear_tag(EntityTag the_tag) { tags_ &= ~tag_bit(the_tag); }
 
 // Clears multiple EntityTags from this Entity.
-void Entity::clear_tags(std::initializer_list<EntityTag> tag_list) { for (auto &the_tag : tag_list) clear_tag(the_tag); }
+void Entity::clear_tags(std::initializer_list<EntityTag> tag_list) { tags_ &= ~tag_bits(tag_list); }
 
 // Gets the colour of this Entity.
 Colour Entity::colour() const { return colour_; }
@@ -42,20 +39,13 @@ float Entity::distance_from(int tile_x, int tile_y) const { return core()->game(
 float Entity::distance_from(std::shared_ptr<Entity> entity) const { return core()->game()->area()->grid_distance(x_, y_, entity->x(), entity->y()); }
 
 // Retrieves an entity property (int), or returns 0 if it is not present.
-int32_t Entity::get_prop(EntityProp prop) const
-{
-    auto result = entity_properties_i_.find(prop);
-    if (result == entity_properties_i_.end()) return 0;
-    else return result->second;
-}
+int32_t Entity::get_prop(EntityProp prop) const { return props_i_[static_cast<int>(prop)]; }
 
 // Retrieves an entity property (float), or returns 0 if it is not present.
-float Entity::get_prop_f(EntityProp prop) const
-{
-    auto result = entity_properties_f_.find(prop);
-    if (result == entity_properties_f_.end()) return 0;
-    else return result->second;
-}
+float Entity::get_prop_f(EntityProp prop) const { return props_f_[static_cast<int>(prop)]; }
+
+// Retrieves this Entity's handle within its Area.
+SlotHandle Entity::handle() const { return handle_; }
 
 // Returns the inventory pointer.
 std::vector<std::shared_ptr<Item>>* Entity::inv() { return &inventory_; }
@@ -144,32 +134,29 @@ void Entity::set_pos(int x, int y)
 {
     if (x < 0 || y < 0) core()->guru()->nonfatal("Invalid call to Entity::set_pos on " + name_ + ": " + std::to_string(x) + "," + std::to_string(y),
         GURU_ERROR);
+    const int old_x = x_, old_y = y_;
     x_ = std::max<int>(x, 0);
     y_ = std::max<int>(y, 0);
+    if (area_ && (x_ != old_x || y_ != old_y)) area_->entity_moved(this, old_x, old_y);
 }
 
 // Sets an entity property (int).
 void Entity::set_prop(EntityProp prop, int32_t value)
 {
-    auto result = entity_properties_i_.find(prop);
-    if (value)
-    {
-        if (result == entity_properties_i_.end()) entity_properties_i_.insert(std::pair<EntityProp, int32_t>(prop, value));
-        else result->second = value;
-    }
-    else if (result == entity_properties_i_.end()) entity_properties_i_.erase(result->first);
+    // Properties which aren't set are always zero, so setting one to zero is the same as clearing it.
+    const int index = static_cast<int>(prop);
+    props_i_[index] = value;
+    if (value) props_set_i_ |= (1u << index);
+    else props_set_i_ &= ~(1u << index);
 }
 
 // Sets an entity property (float).
 void Entity::set_prop_f(EntityProp prop, float value)
 {
-    auto result = entity_properties_f_.find(prop);
-    if (value)
-    {
-        if (result == entity_properties_f_.end()) entity_properties_f_.insert(std::pair<EntityProp, float>(prop, value));
-        else result->second = value;
-    }
-    else if (result == entity_properties_f_.end()) entity_properties_f_.erase(result->first);
+    const int index = static_cast<int>(prop);
+    props_f_[index] = value;
+    if (value) props_set_f_ |= (1u << index);
+    else props_set_f_ &= ~(1u << index);
 }
 
 // Sets multiple entity properties (int) at once.
@@ -178,40 +165,47 @@ void Entity::set_props(std::initializer_list<std::pair<EntityProp, int32_t>> pro
 
 // Sets multiple entity properties (float) at once.
 void Entity::set_props_f(std::initializer_list<std::pair<EntityProp, float>> prop_pairs)
-{ for (auto &prop : prop_pairs) set_prop(prop.first, prop.second); }
+{ for (auto &prop : prop_pairs) set_prop_f(prop.first, prop.second); }
 
 // Sets an EntityTag on this Entity.
-void Entity::set_tag(EntityTag the_tag)
-{
-    if (tags_.count(the_tag) > 0) return;
-    tags_.insert(the_tag);
-}
+void Entity::set_tag(EntityTag the_tag) { tags_ |= tag_bit(the_tag); }
 
 // Sets multiple EntityTags on this Entity.
-void Entity::set_tags(std::initializer_list<EntityTag> tag_list) { for (auto &the_tag : tag_list) set_tag(the_tag); }
+void Entity::set_tags(std::initializer_list<EntityTag> tag_list) { tags_ |= tag_bits(tag_list); }
 
 // Checks if an EntityTag is on this Entity.
-bool Entity::tag(EntityTag the_tag) const { return (tags_.count(the_tag) > 0); }
+bool Entity::tag(EntityTag the_tag) const { return (tags_ & tag_bit(the_tag)); }
+
+// Converts an EntityTag into its bit in the tag bitmask.
+uint64_t Entity::tag_bit(EntityTag the_tag) { return (1ULL << static_cast<uint16_t>(the_tag)); }
+
+// Converts multiple EntityTags into a combined bitmask.
+uint64_t Entity::tag_bits(std::initializer_list<EntityTag> tag_list)
+{
+    uint64_t bits = 0;
+    for (auto &the_tag : tag_list)
+        bits |= tag_bit(the_tag);
+    return bits;
+}
 
 // Checks if multiple EntityTags are all set on this Entity.
 bool Entity::tags(std::initializer_list<EntityTag> tag_list) const
 {
-    for (auto &the_tag : tag_list)
-        if (!tag(the_tag)) return false;
-    return true;
+    const uint64_t bits = tag_bits(tag_list);
+    return ((tags_ & bits) == bits);
 }
 
 // Updates the state of this Entity or takes an AI action.
 void Entity::tick(std::shared_ptr<Entity>)
 {
-    for (auto entity : inventory_)
+    for (auto &entity : inventory_)
         entity->tick(entity);
 }
 
 // As above, but for slower events such as buffs/debuffs ticking.
 void Entity::tick10(std::shared_ptr<Entity>)
 {
-    for (auto entity : inventory_)
+    for (auto &entity : inventory_)
         entity->tick10(entity);
 }
 
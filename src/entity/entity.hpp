@@ -6,18 +6,19 @@
 
 #include <cstdint>
 #include <initializer_list>
-#include <map>
 #include <memory>
-#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "util/slot-map.hpp"
+
 
 namespace invictus
 {
 
 enum class Colour : uint8_t;    // defined in terminal/terminal-shared-defs.hpp
+class Area;     // defined in area/area.hpp
 class Item;     // defined in entity/item.hpp
 class Window;   // defined in terminal/window.hpp
 
@@ -30,63 +31,46 @@ enum class EntityProp : uint16_t
     DAMAGE_DICE_B,  // The number of faces on each damage die.
     LIGHT_POWER,    // The power of a light source.
     MAX_FINESSE,    // The maximum amount of finesse bonus that can be used when this Item is equipped.
+    _END            // Not a property; marks the end of the list. Each property is one bit in a uint32_t, so there can be no more than 32.
 };
 
-// Binary tags that can be set on all kinds of Entities.
+// Binary tags that can be set on all kinds of Entities. Each one is a bit index into the Entity's tag bitmask, so these must stay dense, and there can be
+// no more than 64 of them. Tags for each kind of Entity are kept together, so they occupy neighbouring bits. Save files from before the bitmask used
+// different numeric IDs, which are converted in SaveLoad::load_entity().
 enum class EntityTag : uint16_t
 {
-    None = 0,   // This is not a tag.
-
-    /**********************************************
-     * 1 - 9999  --  TAGS GENERIC TO ALL ENTITIES *
-     **********************************************/
-
-    ProperNoun = 1, // This Entity's name is a proper noun (e.g. Smaug).
-    PluralName = 2, // This Entity's name is a plural (e.g. "pack of rats").
-    NoA = 3,        // This Entity's name should not be prefaced with 'a' (e.g. 'plate mail armour' instead of 'a plate mail armour').
-
-
-    /*******************************************
-     * 10000 - 19999  --  PLAYER-SPECIFIC TAGS *
-     *******************************************/
-
-
-    /*******************************************
-     * 20000 - 29999  --  MOBILE-SPECIFIC TAGS *
-     *******************************************/
-
-    // 20000 - 20999 -- General-purpose tags regarding this Mobile's state of being.
-    Unliving = 20000,       // This Mobile is either undead or an unliving construct.
-    ImmunityBleed,          // This Mobile cannot bleed.
-    ImmunityPoison,         // This Mobile cannot be poisoned.
-
-    // 21000 - 21999 -- Combat-related tags.
-    CannotBlock = 21000,    // This Mobile cannot use a shield to block in combat.
-    CannotParry,            // This Mobile is unable to parry attacks.
-    Passive,                // This Mobile will not attack the player unless the player strikes first.
-    Blind,                  // If this tag is NOT set, the Mobile will hunt the player by sight.
-
-    // 22000 - 22999 -- Temporary tags, which are set during gameplay.
-    NoDeathMessage = 23000, // When this Mobile dies, it will not display a death message.
-
-
-    /*****************************************
-     * 30000 - 30999  --  ITEM-SPECIFIC TAGS *
-     *****************************************/
-
-    // 30000 - 32999 -- Generic item tags not specific to any particular type of item.
-
-    // 33000 - 33499 -- Tags specific to weapons.
-    TwoHanded = 33000,  // This Item is a weapon which takes both hands to wield.
-    HandAndAHalf,       // This Item is a weapon which can be equipped in either one or both hands.
-    WeaponRanged,       // This Item is a ranged weapon.
-    WeaponFinesse,      // This weapon can get hit/damage bonuses from either Might or Finesse.
-    WeaponLight,        // This weapon does not have a penalty when dual-wielding.
-
-    // 33500 - 33999 -- Tags specific to armour.
-    ArmourLight = 33500,    // This armour is lightweight, and allows for adding the user's Finesse bonus.
-    ArmourMedium,           // This armour is medium, and partially limits the user's Finesse bonus.
-    ArmourHeavy,            // This armour is heavy, and allows no Finesse bonus at all.
+    // Tags generic to all Entities.
+    ProperNoun,     // This Entity's name is a proper noun (e.g. Smaug).
+    PluralName,     // This Entity's name is a plural (e.g. "pack of rats").
+    NoA,            // This Entity's name should not be prefaced with 'a' (e.g. 'plate mail armour' instead of 'a plate mail armour').
+
+    // Mobile-specific tags regarding this Mobile's state of being.
+    Unliving,       // This Mobile is either undead or an unliving construct.
+    ImmunityBleed,  // This Mobile cannot bleed.
+    ImmunityPoison, // This Mobile cannot be poisoned.
+
+    // Mobile-specific combat-related tags.
+    CannotBlock,    // This Mobile cannot use a shield to block in combat.
+    CannotParry,    // This Mobile is unable to parry attacks.
+    Passive,        // This Mobile will not attack the player unless the player strikes first.
+    Blind,          // If this tag is NOT set, the Mobile will hunt the player by sight.
+
+    // Temporary Mobile tags, which are set during gameplay.
+    NoDeathMessage, // When this Mobile dies, it will not display a death message.
+
+    // Item tags specific to weapons.
+    TwoHanded,      // This Item is a weapon which takes both hands to wield.
+    HandAndAHalf,   // This Item is a weapon which can be equipped in either one or both hands.
+    WeaponRanged,   // This Item is a ranged weapon.
+    WeaponFinesse,  // This weapon can get hit/damage bonuses from either Might or Finesse.
+    WeaponLight,    // This weapon does not have a penalty when dual-wielding.
+
+    // Item tags specific to armour.
+    ArmourLight,    // This armour is lightweight, and allows for adding the user's Finesse bonus.
+    ArmourMedium,   // This armour is medium, and partially limits the user's Finesse bonus.
+    ArmourHeavy,    // This armour is heavy, and allows no Finesse bonus at all.
+
+    _END            // Not a real tag; this must always be last, so we know how many tags there are.
 };
 
 // Types of Entity and derived classes.
@@ -113,6 +97,7 @@ public:
     Colour              colour() const; // Gets the colour of this Entity.
     float               distance_from(int tile_x, int tile_y) const;            // Gets this Entity's distance from a specified tile.
     float               distance_from(std::shared_ptr<Entity> entity) const;    // As above, but measuring distance to an Entity.
+    SlotHandle          handle() const; // Retrieves this Entity's handle within its Area.
     std::vector<std::shared_ptr<Item>>* inv();          // Returns the inventory pointer.
     void                inventory_add(std::shared_ptr<Entity> entity);  // Adds an Entity to this Entity's inventory.
     void                inventory_add(std::shared_ptr<Item> item);      // As above, but for an Entity in Item form.
@@ -145,15 +130,22 @@ protected:
     void        set_props_f(std::initializer_list<std::pair<EntityProp, float>> prop_pairs);    // Sets multiple entity properties (float) at once.
 
 private:
+    static uint64_t tag_bit(EntityTag the_tag); // Converts an EntityTag into its bit in the tag bitmask.
+    static uint64_t tag_bits(std::initializer_list<EntityTag> tag_list);    // Converts multiple EntityTags into a combined bitmask.
+
+    Area*       area_;      // The Area whose spatial index this Entity is in, if any. The Area manages this pointer itself.
     char        ascii_;     // The ASCII character representing this Entity.
     Colour      colour_;    // The colour of this Entity.
-    std::map<EntityProp, float>     entity_properties_f_;   // Various properties that can be on this Entity (floats).
-    std::map<EntityProp, int32_t>   entity_properties_i_;   // Various properties that can be on this Entity (ints).
+    SlotHandle  handle_;        // This Entity's handle within its Area, which the Area sets when the Entity is added.
     std::vector<std::shared_ptr<Item>>    inventory_;       // The things carried by this Entity.
     std::string name_;          // The name of this Entity.
-    std::set<EntityTag> tags_;  // Any and all EntityTags on this Entity.
+    float       props_f_[static_cast<int>(EntityProp::_END)];   // Various properties that can be on this Entity (floats), indexed by EntityProp.
+    int32_t     props_i_[static_cast<int>(EntityProp::_END)];   // Various properties that can be on this Entity (ints), indexed by EntityProp.
+    uint32_t    props_set_f_, props_set_i_; // Which of the above properties are set, with one bit for each EntityProp.
+    uint64_t    tags_;          // Any and all EntityTags on this Entity, as a bitmask.
     uint16_t    x_, y_;         // Position on the map.
 
+friend class Area;
 friend class CodexItem;
 friend class CodexMonster;
 friend class SaveLoad;
@@ -33,7 +33,7 @@ std::pair<uint8_t, uint8_t> Item::damage() const { return { get_prop(EntityProp:
 int Item::damage_roll() const
 {
     int dice = get_prop(EntityProp::DAMAGE_DICE_A), sides = get_prop(EntityProp::DAMAGE_DICE_B);
-    return Random::roll(dice, sides);
+    return Random::roll(dice, sides, RNG::COMBAT);
 }
 
 // Returns the sub-type of this Item.
@@ -12,6 +12,7 @@
 #include "core/core.hpp"
 #include "core/game-manager.hpp"
 #include "core/guru.hpp"
+#include "core/scheduler.hpp"
 #include "entity/buff.hpp"
 #include "entity/item.hpp"
 #include "entity/monster.hpp"
@@ -50,7 +51,7 @@ void Mobile::add_bloody_feet(float blood) { bloody_feet_ += blood; }
 void Mobile::add_buff(BuffType type, int power, int duration, bool extend)
 {
     // Look for an existing, identical Buff to update.
-    for (auto buff : buffs_)
+    for (auto &buff : buffs_)
     {
         if (buff->get_type() != type) continue;
         if (buff->get_power() < power) buff->set_power(power);
@@ -85,14 +86,7 @@ void Mobile::close_door(int dx, int dy)
     auto monster = (type() == EntityType::MONSTER ? dynamic_cast<Monster*>(this) : nullptr);
 
     if (!is_player && monster->banked_ticks() < TIME_CLOSE_DOOR) return;
-    for (auto mobile : *area->entities())
-    {
-        if (mobile->is_at(dx, dy))
-        {
-            success = false;
-            break;
-        }
-    }
+    if (area->is_occupied(dx, dy)) success = false;
 
     auto the_tile = area->tile(dx, dy);
     if (!success)
@@ -114,7 +108,6 @@ void Mobile::close_door(int dx, int dy)
     the_tile->set_ascii(ASCII_DOOR_CLOSED);
     the_tile->set_tags({TileTag::Openable, TileTag::BlocksLight});
     the_tile->clear_tags({TileTag::Closeable, TileTag::Open});
-    area->need_fov_recalc();
     timed_action(TIME_CLOSE_DOOR);
 }
 
@@ -133,6 +126,7 @@ void Mobile::die()
     }
 
     hp_[0] = 0;
+    core()->game()->area()->remove_actor(this);
     if (type() != EntityType::PLAYER) set_ascii(ASCII_CORPSE);
     if (can_bleed) set_colour(Colour::RED);
     set_name(name(NAME_FLAG_POSSESSIVE) + (unliving ? " remains" : " corpse"));
@@ -147,9 +141,9 @@ void Mobile::drop_item(uint32_t id)
     if (id >= inv()->size()) core()->guru()->halt("Invalid item ID for drop", id, inv()->size());
     if (type() == EntityType::MONSTER && monster->banked_ticks() < TIME_DROP_ITEM) return;
     std::shared_ptr<Entity> item = inv()->at(id);
-    core()->game()->area()->entities()->push_back(item);
     inv()->erase(inv()->begin() + id);
     item->set_pos(x(), y());
+    core()->game()->area()->add_entity(item);
 
     if (type() == EntityType::PLAYER) core()->message("You drop {c}" + item->name(NAME_FLAG_THE) + " {w}on the ground.", AWAKEN_CHANCE_DROP_ITEM);
     else if (is_in_fov()) core()->message("{u}" + name(NAME_FLAG_THE | NAME_FLAG_CAPITALIZE_FIRST) + " {u}drops " + item->name(NAME_FLAG_A) +
@@ -272,7 +266,7 @@ std::shared_ptr<Item> Mobile::equipment(EquipSlot slot)
 // Checks if this Mobile has a specified buff/debuff.
 int Mobile::has_buff(BuffType type) const
 {
-    for (auto buff : buffs_)
+    for (auto &buff : buffs_)
         if (buff->get_type() == type) return buff->get_power();
     return 0;
 }
@@ -321,24 +315,19 @@ bool Mobile::move_or_attack(std::shared_ptr<Mobile> self, int dx, int dy)
             tile->set_ascii(ASCII_DOOR_OPEN);
             tile->clear_tags({TileTag::Openable, TileTag::BlocksLight});
             tile->set_tags({TileTag::Closeable, TileTag::Open});
-            area->need_fov_recalc();
             timed_action(TIME_OPEN_DOOR);
             return true;
         }
 
         set_pos(xdx, ydy);
         if (monster) monster->set_last_dir(((dx + 2) << 4) + (dy + 2));
-        area->need_fov_recalc();
         game->ui()->redraw_dungeon();
 
         if (is_player)
         {
             std::vector<std::string> floor_items;
-            for (auto entity : *area->entities())
-            {
-                if (entity == self || !entity->is_at(self)) continue;
+            for (auto &entity : area->entities_at(xdx, ydy))
                 floor_items.push_back(entity->name());
-            }
             if (floor_items.size()) core()->message("You see {c}" + StrX::comma_list(floor_items, true) + " {w}here.", 0);
             Tile* self_tile = area->tile(xdx, ydy);
             if (self_tile->tag(TileTag::StairsDown)) core()->message("You see a staircase leading downward.");
@@ -352,7 +341,7 @@ bool Mobile::move_or_attack(std::shared_ptr<Mobile> self, int dx, int dy)
             const int gore_level = Gore::gore_level(x(), y());
             if (bloody_feet() < gore_level)
             {
-                add_bloody_feet(Random::rng_float(0, (gore_level > GORE_BLOODY_FEET_MAX ? GORE_BLOODY_FEET_MAX : gore_level)));
+                add_bloody_feet(Random::rng_float(0, (gore_level > GORE_BLOODY_FEET_MAX ? GORE_BLOODY_FEET_MAX : gore_level), RNG::GORE));
                 if (bloody_feet() > gore_level) add_bloody_feet(-(bloody_feet() - gore_level));
             }
         }
@@ -360,7 +349,7 @@ bool Mobile::move_or_attack(std::shared_ptr<Mobile> self, int dx, int dy)
         // Check to see if we're going to be tracking blood and gore around.
         else
         {
-            float gore_dropped = Random::rng_float(0, bloody_feet());
+            float gore_dropped = Random::rng_float(0, bloody_feet(), RNG::GORE);
             add_bloody_feet(-gore_dropped);
             if (gore_dropped >= 1) Gore::set_gore(x(), y(), std::round(gore_dropped));
         }
@@ -369,20 +358,29 @@ bool Mobile::move_or_attack(std::shared_ptr<Mobile> self, int dx, int dy)
         return true;
     }
     if (!is_player && monster->banked_ticks() < attack_speed()) return false;
-    for (auto entity : *core()->game()->area()->entities())
+    if (xdx >= 0 && ydy >= 0 && xdx < area->width() && ydy < area->height())
     {
-        if (entity.get() == this) continue; // Ignore ourselves on the list.
-        if (!entity->is_at(xdx, ydy)) continue; // Ignore anything not in the target tile.
-        if (entity->type() != EntityType::MONSTER && entity->type() != EntityType::PLAYER) continue;    // Ignore anything that isn't a Monster (or the player).
-
-        // This is safe -- we just checked above, only Monster and Player (derived classes of Mobile) can continue to this point in the loop.
-        // In case anything could possibly go wrong, dynamic_pointer_cast will either throw an exception or return a null pointer.
-        auto mob = std::dynamic_pointer_cast<Mobile>(entity);
-        // The dead can't fight back. Okay, that's not strictly true, zombies and skeletons can be pretty feisty, but you know what I mean.
-        if (mob->is_dead()) continue;
-
-        timed_action(attack_speed());
-        return Combat::bump_attack(self, mob);
+        // The player isn't on the Area's spatial index, so check them first.
+        if (!is_player && player->is_at(xdx, ydy) && !player->is_dead())
+        {
+            timed_action(attack_speed());
+            return Combat::bump_attack(self, player);
+        }
+
+        for (auto &entity : area->entities_at(xdx, ydy))
+        {
+            if (entity.get() == this) continue; // Ignore ourselves on the list.
+            if (entity->type() != EntityType::MONSTER) continue;    // Ignore anything that isn't a Monster.
+
+            // This is safe -- we just checked above, only Monster (a derived class of Mobile) can continue to this point in the loop, so there's no
+            // need for the overhead of dynamic_pointer_cast.
+            auto mob = std::static_pointer_cast<Mobile>(entity);
+            // The dead can't fight back. Okay, that's not strictly true, zombies and skeletons can be pretty feisty, but you know what I mean.
+            if (mob->is_dead()) continue;
+
+            timed_action(attack_speed());
+            return Combat::bump_attack(self, mob);
+        }
     }
 
     // We're not taking an action right now.
@@ -452,19 +450,18 @@ void Mobile::take_damage(int damage)
 }
 
 // Picks up a specified item.
-void Mobile::take_item(uint32_t id)
+void Mobile::take_item(SlotHandle handle)
 {
     auto area = core()->game()->area();
-    auto entities = area->entities();
     auto monster = (type() == EntityType::MONSTER ? dynamic_cast<Monster*>(this) : nullptr);
 
-    if (entities->size() <= id) core()->guru()->halt("Attempt to pick up invalid item ID.", id);
-    std::shared_ptr<Entity> entity = entities->at(id);
-    if (entity->type() != EntityType::ITEM) core()->guru()->halt("Attempt to pick up non-item entity.", id);
+    std::shared_ptr<Entity> entity = area->entity(handle);
+    if (!entity) core()->guru()->halt("Attempt to pick up invalid item handle.", handle.index, handle.generation);
+    if (entity->type() != EntityType::ITEM) core()->guru()->halt("Attempt to pick up non-item entity.", handle.index);
     if (type() != EntityType::PLAYER && monster->banked_ticks() < TIME_TAKE_ITEM) return;
 
+    area->remove_entity(handle);
     inventory_add(entity);
-    entities->erase(entities->begin() + id);
     if (type() == EntityType::PLAYER) core()->message("You pick up {c}" + entity->name(NAME_FLAG_A) + "{w}.");
     else if (is_in_fov()) core()->message("{u}" + name() + " {u}picks up " + entity->name(NAME_FLAG_A) + "{u}.", AWAKEN_CHANCE_MOB_TAKE_ITEM);
     timed_action(TIME_TAKE_ITEM);
@@ -510,13 +507,13 @@ void Mobile::tick10(std::shared_ptr<Entity> self)
         if (tile->id() == TileID::DRUJ_TOMB)
         {
             if (!player_in_los) return; // Druj don't awaken until the player can see them.
-            if (Random::rng(1, player_distance) == 1)   // The closer the player gets, the higher the awaken chance.
+            if (Random::rng(1, player_distance, RNG::AI) == 1)   // The closer the player gets, the higher the awaken chance.
             {
                 wake_message(EnemyWakeMsg::DRUJ_TOMB, false);
                 wake();
             }
             // If the first check fails, we'll run another check to give the player a warning that the druj is awakening.
-            else if (Random::rng(1, player_distance) == 1) wake_message(EnemyWakeMsg::DRUJ_TOMB, true);
+            else if (Random::rng(1, player_distance, RNG::AI) == 1) wake_message(EnemyWakeMsg::DRUJ_TOMB, true);
         }
         else
         {
@@ -583,6 +580,7 @@ void Mobile::unequip_item(EquipSlot slot)
 void Mobile::wake()
 {
     awake_ = true;
+    if (core()->game() && core()->game()->scheduler()) core()->game()->scheduler()->mobile_woke();
     if (core()->game() && core()->game()->ui()) core()->game()->ui()->redraw_nearby();
 }
 
@@ -59,7 +59,7 @@ public:
     void            sleep();    // Sends this Mobile to sleep.
     uint16_t        sp(bool max = false) const; // Retrieves the current or maximum stamina points of this Mobile.
     void            take_damage(int damage);    // Takes damage!
-    void            take_item(uint32_t id); // Picks up a specified item.
+    void            take_item(SlotHandle handle);   // Picks up a specified item.
     virtual void    tick(std::shared_ptr<Entity> self) override;    // Processes AI for this Mobile each turn.
     void            tick10(std::shared_ptr<Entity> self) override;  // Process slower state-change events that happen less often, such as buffs/debuffs ticking.
     void            tick_buffs(std::shared_ptr<Mobile> self);       // Ticks any buff/debuffs on this Mobile.
@@ -2,6 +2,7 @@
 // Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
 
 #include "area/area.hpp"
+#include "area/dijkstra-map.hpp"
 #include "area/pathfind.hpp"
 #include "core/core.hpp"
 #include "core/game-manager.hpp"
@@ -76,21 +77,22 @@ void Monster::tick(std::shared_ptr<Entity> self)
         set_tracking_turns(AI_TRACKING_TURNS);
         player_last_seen_x_ = player->x();
         player_last_seen_y_ = player->y();
-        auto pathfind = std::make_shared<Pathfind>(PathfindMode::PATHFIND_MONSTER, x(), y(), player_last_seen_x_, player_last_seen_y_);
-        auto result = pathfind->pathfind();
-        if (!result.size())
+
+        // Every Monster hunting the player shares the same distance map, so this is far cheaper than pathfinding from each Monster separately.
+        const std::pair<int, int> step = area->player_distance_map()->descend(area.get(), x(), y());
+        if (step.first == 0 && step.second == 0)
         {
             clear_banked_ticks();   // Can't find any route, so just do nothing.
             return;
         }
 
         // Find the next step in the path.
-        int next_x = result.at(0).first, next_y = result.at(0).second;
+        int next_x = x() + step.first, next_y = y() + step.second;
 
         // Check to see if anything is blocking the way.
-        for (auto entity : *core()->game()->area()->entities())
+        for (auto &entity : area->entities_at(next_x, next_y))
         {
-            if (entity == self || entity->type() == EntityType::PLAYER) continue;
+            if (entity == self) continue;
             if (entity->blocks_tile(next_x, next_y))
             {
                 clear_banked_ticks();
@@ -166,7 +168,7 @@ void Monster::tick(std::shared_ptr<Entity> self)
             }
 
             // There's now at least one viable option. Let's choose one randomly from the available list.
-            int choice = Random::rng(0, viable_directions.size() - 1);
+            int choice = Random::rng(0, viable_directions.size() - 1, RNG::AI);
             dy = (viable_directions.at(choice) & 0xF) - 2;
             dx = ((viable_directions.at(choice) & 0xF0) >> 4) - 2;
         }
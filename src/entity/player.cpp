@@ -146,13 +146,9 @@ void Player::get_direction(int *dx, int *dy) const
 void Player::get_item()
 {
     auto area = core()->game()->area();
-    std::vector<uint32_t> items_nearby;
-    for (unsigned int i = 0; i < area->entities()->size(); i++)
-    {
-        auto entity = area->entities()->at(i);
-        if (entity->type() != EntityType::ITEM) continue;
-        if (entity->is_at(x(), y())) items_nearby.push_back(i);
-    }
+    std::vector<SlotHandle> items_nearby;
+    for (auto &entity : area->entities_at(x(), y()))
+        if (entity->type() == EntityType::ITEM) items_nearby.push_back(entity->handle());
     if (!items_nearby.size()) core()->message("{y}There isn't anything you can pick up here.");
     else if (items_nearby.size() == 1)
     {
@@ -166,31 +162,27 @@ void Player::get_item()
 void Player::ground_items()
 {
     auto area = core()->game()->area();
-    std::vector<uint32_t> items_nearby;
-    for (unsigned int i = 0; i < area->entities()->size(); i++)
-    {
-        auto entity = area->entities()->at(i);
-        if (entity->type() != EntityType::ITEM) continue;
-        if (entity->is_at(x(), y())) items_nearby.push_back(i);
-    }
+    std::vector<SlotHandle> items_nearby;
+    for (auto &entity : area->entities_at(x(), y()))
+        if (entity->type() == EntityType::ITEM) items_nearby.push_back(entity->handle());
     if (!items_nearby.size()) core()->message("{y}There's nothing to interact with here.");
 
     auto items_menu = std::make_unique<Menu>();
     items_menu->set_title("Nearby Items");
-    for (auto id : items_nearby)
+    for (auto handle : items_nearby)
     {
-        auto entity = area->entities()->at(id);
+        auto entity = area->entity(handle);
         items_menu->add_item(entity->name(), entity->ascii(), entity->colour(), true);
     }
     int result = items_menu->render();
-    if (result >= 0 && result < static_cast<int>(items_nearby.size())) item_interaction(items_nearby.at(result), ItemLocation::GROUND);
+    if (result >= 0 && result < static_cast<int>(items_nearby.size())) item_interaction(0, ItemLocation::GROUND, items_nearby.at(result));
 }
 
 // Retrieves this Player's intellect attribute.
 int8_t Player::intellect() const { return intellect_; }
 
-// Interacts with an item.
-void Player::item_interaction(uint32_t id, ItemLocation loc)
+// Interacts with an item. Items on the ground are specified by their handle rather than an ID.
+void Player::item_interaction(uint32_t id, ItemLocation loc, SlotHandle ground_handle)
 {
     std::shared_ptr<Entity> entity = nullptr;
     std::shared_ptr<Item> item = nullptr;
@@ -207,9 +199,8 @@ void Player::item_interaction(uint32_t id, ItemLocation loc)
             break;
         case ItemLocation::GROUND:
         {
-            auto area = core()->game()->area();
-            if (area->entities()->size() <= id) core()->guru()->halt("Invalid item interaction ID", id, area->entities()->size());
-            entity = area->entities()->at(id);
+            entity = core()->game()->area()->entity(ground_handle);
+            if (!entity) core()->guru()->halt("Invalid item interaction handle", ground_handle.index, ground_handle.generation);
             break;
         }
     }
@@ -253,7 +244,7 @@ void Player::item_interaction(uint32_t id, ItemLocation loc)
         case ItemInteraction::DO_NOTHING: return;
         case ItemInteraction::DROP: drop_item(id); break;
         case ItemInteraction::EQUIP: equip_item(id); break;
-        case ItemInteraction::TAKE: take_item(id); break;
+        case ItemInteraction::TAKE: take_item(ground_handle); break;
         case ItemInteraction::UNEQUIP: unequip_item(static_cast<EquipSlot>(id)); break;
     }
 }
@@ -344,6 +335,11 @@ void Player::reduce_rest_time(float amount)
 void Player::rest()
 {
     auto game = core()->game();
+    if (game->area()->hostile_in_fov())
+    {
+        core()->message("{y}You can't rest with enemies in sight!");
+        return;
+    }
     core()->message("{u}How long do you want to rest? Enter a number of turns, or {c}* {u}to rest until fully healed.");
     std::string result = core()->game()->ui()->msglog()->get_string();
     if (!result.size()) core()->message("{y}Not resting.");
@@ -422,7 +418,7 @@ void Player::take_inventory(bool equipment)
         auto inv_menu = std::make_unique<Menu>();
         inv_menu->set_title("Inventory");
         inv_menu->left_aligned(true);
-        for (auto item : *inv())
+        for (auto &item : *inv())
             inv_menu->add_item(item->name(), item->ascii(), item->colour(), true);
         int result = inv_menu->render();
         if (result >= 0) item_interaction(result, ItemLocation::INVENTORY);
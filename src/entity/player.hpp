@@ -26,7 +26,7 @@ public:
     void        get_item();         // Picks something up off the ground.
     void        ground_items();     // Interact with items on the ground.
     int8_t      intellect() const;  // Retrieves thisPlayer's intellect attribute.
-    void        item_interaction(uint32_t id, ItemLocation loc);    // Interacts with an item.
+    void        item_interaction(uint32_t id, ItemLocation loc, SlotHandle ground_handle = SlotHandle());  // Interacts with an item.
     int8_t      might() const;      // Retrieves this Player's might attribute.
     void        open_a_door();      // Attempts to open a nearby door.
     void        recalc_max_hp_mp_sp();  // Recalculates the maximum HP/SP/MP values, based on Strength, Finesse and Intellect.
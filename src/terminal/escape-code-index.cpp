@@ -56,7 +56,10 @@ std::map<std::string, int> Terminal::escape_code_index_ = {
     { "\x1b[b", Key::ARROW_DOWN }, { "\x1b[c", Key::ARROW_RIGHT }, { "\x1b[d", Key::ARROW_LEFT }, { "\x1bOM", Key::ENTER }, { "\x1bOa", Key::ARROW_UP },
     { "\x1bOb", Key::ARROW_DOWN }, { "\x1bOc", Key::ARROW_RIGHT }, { "\x1bOd", Key::ARROW_LEFT }, { "\x1bOl", '+' }, { "\x1bOn", '.' }, { "\x1bOp", Key::KP0 },
     { "\x1bOq", Key::KP1 }, { "\x1bOr", Key::KP2 }, { "\x1bOs", Key::KP3 }, { "\x1bOt", Key::KP4 }, { "\x1bOu", Key::KP5 }, { "\x1bOv", Key::KP6 },
-    { "\x1bOw", Key::KP7 }, { "\x1bOx", Key::KP8 },  { "\x1bOy", Key::KP9 }, { "\x1b[1~", Key::HOME }, { "\x1b[4~", Key::END }
+    { "\x1bOw", Key::KP7 }, { "\x1bOx", Key::KP8 },  { "\x1bOy", Key::KP9 }, { "\x1b[1~", Key::HOME }, { "\x1b[4~", Key::END },
+    { "\x1b[A", Key::ARROW_UP }, { "\x1b[B", Key::ARROW_DOWN }, { "\x1b[C", Key::ARROW_RIGHT }, { "\x1b[D", Key::ARROW_LEFT }, { "\x1b[F", Key::END },
+    { "\x1b[H", Key::HOME }, { "\x1bOA", Key::ARROW_UP }, { "\x1bOB", Key::ARROW_DOWN }, { "\x1bOC", Key::ARROW_RIGHT }, { "\x1bOD", Key::ARROW_LEFT },
+    { "\x1bOF", Key::END }, { "\x1bOH", Key::HOME }, { "\x1bOP", Key::F1 }, { "\x1bOQ", Key::F2 }, { "\x1bOR", Key::F3 }, { "\x1bOS", Key::F4 }
 };
 
 }   // namespace invictus
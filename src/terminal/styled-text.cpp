@@ -0,0 +1,129 @@
+// terminal/styled-text.cpp -- Colour-tagged strings, parsed once into plain text and colour spans, so they can be measured, wrapped and printed cheaply.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#include "terminal/styled-text.hpp"
+
+
+namespace invictus
+{
+
+// Constructor, creates an empty StyledText.
+StyledText::StyledText() { }
+
+// Constructor, parses a colour-tagged string.
+StyledText::StyledText(const std::string &str) : tagged_(str) { parse(); }
+
+// Adds more colour-tagged text to the end.
+void StyledText::append(const std::string &str)
+{
+    // Whether the text starts with a colour tag affects how all of it is coloured, so it's simplest to just parse the whole thing again.
+    tagged_ += str;
+    parse();
+}
+
+// Checks if there's no text at all.
+bool StyledText::empty() const { return text_.empty(); }
+
+// Returns the length of the text when printed, without the colour tags.
+uint32_t StyledText::length() const { return text_.size(); }
+
+// Parses the colour-tagged string into plain text and colour spans.
+void StyledText::parse()
+{
+    spans_.clear();
+    text_.clear();
+    text_.reserve(tagged_.size());
+
+    // If there are any colour tags at all, but the string doesn't start with one, everything before the first tag is white, as with Terminal::print().
+    Colour colour = Colour::WHITE;
+    bool tagged = (tagged_.size() && tagged_[0] != '{' && tagged_.find('{') != std::string::npos);
+    for (size_t i = 0; i < tagged_.size(); i++)
+    {
+        if (tagged_[i] == '{' && i + 2 < tagged_.size() && tagged_[i + 2] == '}')
+        {
+            // Unrecognized tags (such as the wiki's {e} for centred text) are removed, but don't change the colour.
+            bool known_tag = true;
+            switch(tagged_[i + 1])
+            {
+                case 'b': colour = Colour::BLACK; break;
+                case 'B': colour = Colour::BLACK_BOLD; break;
+                case 'r': colour = Colour::RED; break;
+                case 'R': colour = Colour::RED_BOLD; break;
+                case 'g': colour = Colour::GREEN; break;
+                case 'G': colour = Colour::GREEN_BOLD; break;
+                case 'y': colour = Colour::YELLOW; break;
+                case 'Y': colour = Colour::YELLOW_BOLD; break;
+                case 'u': colour = Colour::BLUE; break;
+                case 'U': colour = Colour::BLUE_BOLD; break;
+                case 'm': colour = Colour::MAGENTA; break;
+                case 'M': colour = Colour::MAGENTA_BOLD; break;
+                case 'c': colour = Colour::CYAN; break;
+                case 'C': colour = Colour::CYAN_BOLD; break;
+                case 'w': colour = Colour::WHITE; break;
+                case 'W': colour = Colour::WHITE_BOLD; break;
+                default: known_tag = false; break;
+            }
+            if (known_tag) tagged = true;
+            i += 2;
+            continue;
+        }
+
+        if (!spans_.size() || spans_.back().colour != colour || spans_.back().tagged != tagged)
+            spans_.push_back({static_cast<uint32_t>(text_.size()), 0, colour, tagged});
+        spans_.back().length++;
+        text_ += tagged_[i];
+    }
+}
+
+// Returns the colour spans which make up the text.
+const std::vector<StyledText::Span>& StyledText::spans() const { return spans_; }
+
+// Returns the original colour-tagged string.
+const std::string& StyledText::tagged() const { return tagged_; }
+
+// Returns the plain text, with all colour tags removed.
+const std::string& StyledText::text() const { return text_; }
+
+// Word-wraps the text to a given line length, adding each line to a vector.
+void StyledText::wrap(unsigned int line_len, std::vector<Line> &lines) const
+{
+    const uint32_t len = text_.size();
+    if (!len) return;
+    if (len <= line_len || !line_len)
+    {
+        lines.push_back({0, len});
+        return;
+    }
+
+    uint32_t line_start = 0, line_end = 0, pos = 0;
+    bool line_empty = true;
+    while (pos <= len)
+    {
+        size_t word_end = text_.find(' ', pos);
+        if (word_end == std::string::npos) word_end = len;
+        uint32_t word_len = word_end - pos;
+
+        // Start a new line if this word won't fit on the current one, along with the space before it.
+        if (!line_empty && (line_end - line_start) + 1 + word_len > line_len)
+        {
+            lines.push_back({line_start, line_end - line_start});
+            line_empty = true;
+        }
+        if (line_empty) line_start = pos;
+
+        // Words too long to fit on a line at all just get split up.
+        while (word_len > line_len)
+        {
+            lines.push_back({pos, line_len});
+            pos += line_len;
+            word_len -= line_len;
+            line_start = pos;
+        }
+        line_end = pos + word_len;
+        line_empty = false;
+        pos = word_end + 1;
+    }
+    lines.push_back({line_start, line_end - line_start});
+}
+
+}   // namespace invictus
@@ -0,0 +1,55 @@
+// terminal/styled-text.hpp -- Colour-tagged strings, parsed once into plain text and colour spans, so they can be measured, wrapped and printed cheaply.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef TERMINAL_STYLED_TEXT_HPP_
+#define TERMINAL_STYLED_TEXT_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "terminal/terminal-shared-defs.hpp"
+
+
+namespace invictus
+{
+
+class StyledText
+{
+public:
+    // A run of the plain text which is all printed in the same colour.
+    struct Span
+    {
+        uint32_t    offset; // Where this span starts in the plain text.
+        uint32_t    length; // The length of this span.
+        Colour      colour; // The colour set by the last colour tag.
+        bool        tagged; // Was the colour set by a tag? If not, this span is printed in whatever colour is given to Terminal::print().
+    };
+
+    // A single line of word-wrapped text, as a section of the plain text.
+    struct Line
+    {
+        uint32_t    offset; // Where this line starts in the plain text.
+        uint32_t    length; // The length of this line.
+    };
+
+                StyledText();   // Constructor, creates an empty StyledText.
+    explicit    StyledText(const std::string &str); // Constructor, parses a colour-tagged string.
+    void        append(const std::string &str);     // Adds more colour-tagged text to the end.
+    bool        empty() const;      // Checks if there's no text at all.
+    uint32_t    length() const;     // Returns the length of the text when printed, without the colour tags.
+    const std::vector<Span>&    spans() const;  // Returns the colour spans which make up the text.
+    const std::string&  tagged() const; // Returns the original colour-tagged string.
+    const std::string&  text() const;   // Returns the plain text, with all colour tags removed.
+    void        wrap(unsigned int line_len, std::vector<Line> &lines) const;    // Word-wraps the text to a given line length, adding each line to a vector.
+
+private:
+    void        parse();    // Parses the colour-tagged string into plain text and colour spans.
+
+    std::vector<Span>   spans_; // The colour spans which make up the text.
+    std::string tagged_;        // The original colour-tagged string.
+    std::string text_;          // The plain text, with all colour tags removed.
+};
+
+}       // namespace invictus
+#endif  // TERMINAL_STYLED_TEXT_HPP_
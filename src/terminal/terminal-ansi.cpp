@@ -0,0 +1,383 @@
+// terminal/terminal-ansi.cpp -- An alternative backend for the Terminal, which bypasses Curses and writes escape sequences directly to the terminal.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef INVICTUS_TARGET_WINDOWS
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+#include "core/core.hpp"
+#include "core/guru.hpp"
+#include "core/prefs.hpp"
+#include "terminal/terminal.hpp"
+#include "terminal/window.hpp"
+#include "tune/terminal.hpp"
+
+
+namespace invictus
+{
+
+namespace
+{
+
+// How each Glyph is drawn: as a UTF-8 character if the matching ACS flag is set in the prefs, or as a plain ASCII character otherwise.
+struct AnsiGlyph
+{
+    const char* utf8;       // The UTF-8 character used when the ACS flag is set.
+    char        ascii;      // The ASCII character used otherwise.
+    uint8_t     acs_flag;   // The ACS flag (1 = box, 2 = VT100, 4 = teletype, 8 = System V, 16 = scan lines) which enables the UTF-8 character.
+};
+
+const AnsiGlyph ansi_glyphs[] = { { "┌", '+', 1 }, { "└", '+', 1 }, { "┐", '+', 1 }, { "┘", '+', 1 }, { "┤", '+', 1 }, { "├", '+', 1 }, { "┴", '+', 1 },
+    { "┬", '+', 1 }, { "─", '-', 1 }, { "│", '|', 1 }, { "┼", '+', 1 }, { "⎺", '-', 16 }, { "⎽", '_', 16 }, { "◆", '*', 2 }, { "▒", '#', 2 },
+    { "°", '\'', 2 }, { "±", '+', 2 }, { "·", '.', 2 }, { "←", '<', 4 }, { "→", '>', 4 }, { "↓", 'v', 4 }, { "↑", '^', 4 }, { "░", '#', 4 },
+    { "␋", '*', 4 }, { "█", '#', 4 }, { "⎻", '-', 16 }, { "⎼", '_', 16 }, { "≤", '<', 8 }, { "≥", '>', 8 }, { "π", '^', 8 }, { "≠", '=', 8 },
+    { "£", '&', 8 } };
+
+const ScreenCell    ANSI_BLANK_CELL = {' ', Colour::NONE, 0};   // An empty cell, as the screen starts out.
+const ScreenCell    ANSI_UNKNOWN_CELL = {UINT32_MAX, Colour::NONE, 0};  // A cell that can't match anything, used to force a cell to be redrawn.
+
+}   // anonymous namespace
+
+
+// Returns a cell on the screen or in a Window, or nullptr if it's out of bounds.
+ScreenCell* Terminal::ansi_cell(std::shared_ptr<Window> window, int x, int y)
+{
+    const int width = get_cols(window), height = get_rows(window);
+    if (x < 0 || y < 0 || x >= width || y >= height) return nullptr;
+    if (window) return &window->front_[x + (y * width)];
+    else return &ansi_screen_[x + (y * width)];
+}
+
+// Returns the escape sequence to set the colour and attributes of a cell.
+std::string Terminal::ansi_sgr(Colour col, unsigned int flags, bool unprintable)
+{
+    if (!has_colour_) return "\x1b[0m";
+    bool bold = (flags & PRINT_FLAG_BOLD) == PRINT_FLAG_BOLD;
+    const bool reverse = (flags & PRINT_FLAG_REVERSE) == PRINT_FLAG_REVERSE;
+    const bool blink = (flags & PRINT_FLAG_BLINK) == PRINT_FLAG_BLINK;
+
+    // This follows the same rules as glyph_code() and colour_pair_code(), so that both backends look the same.
+    if (col == Colour::BLACK_BOLD && reverse)
+    {
+        col = Colour::WHITE;
+        bold = false;
+    }
+    int fg = -1, bg = 0;
+    switch(col)
+    {
+        case Colour::NONE: bg = -1; break;
+        case Colour::BLACK: case Colour::BLACK_BOLD: fg = 0; break;
+        case Colour::RED: case Colour::RED_BOLD: fg = 1; break;
+        case Colour::GREEN: case Colour::GREEN_BOLD: fg = 2; break;
+        case Colour::YELLOW: case Colour::YELLOW_BOLD: fg = 3; break;
+        case Colour::BLUE: case Colour::BLUE_BOLD: fg = 4; break;
+        case Colour::MAGENTA: case Colour::MAGENTA_BOLD: fg = 5; break;
+        case Colour::CYAN: case Colour::CYAN_BOLD: fg = 6; break;
+        case Colour::WHITE: case Colour::WHITE_BOLD: fg = 7; break;
+        case Colour::RED_WHITE: fg = 1; bg = 7; break;
+        case Colour::GREEN_WHITE: fg = 2; bg = 7; break;
+        case Colour::YELLOW_WHITE: fg = 3; bg = 7; break;
+        case Colour::BLUE_WHITE: fg = 4; bg = 7; break;
+        case Colour::MAGENTA_WHITE: fg = 5; bg = 7; break;
+        case Colour::CYAN_WHITE: fg = 6; bg = 7; break;
+        case Colour::BLACK_WHITE: fg = 0; bg = 7; break;
+    }
+    switch(col)
+    {
+        case Colour::BLACK_BOLD: case Colour::RED_BOLD: case Colour::GREEN_BOLD: case Colour::YELLOW_BOLD: case Colour::BLUE_BOLD: case Colour::MAGENTA_BOLD:
+        case Colour::CYAN_BOLD: case Colour::WHITE_BOLD:
+            if ((flags & PRINT_FLAG_DARK) != PRINT_FLAG_DARK) bold = true;
+            break;
+        default: break;
+    }
+
+    std::string sgr = "\x1b[0";
+    if (bold || unprintable) sgr += ";1";
+    if (blink || unprintable) sgr += ";5";
+    if (reverse || unprintable) sgr += ";7";
+    if (fg >= 0) sgr += ";3" + std::to_string(fg);
+    if (bg >= 0) sgr += ";4" + std::to_string(bg);
+    return sgr + "m";
+}
+
+#ifdef INVICTUS_TARGET_WINDOWS
+
+// There's no ANSI backend on Windows, so these are never used, and the Terminal always falls back on Curses.
+void Terminal::ansi_cleanup() { }
+void Terminal::ansi_flip() { }
+int Terminal::ansi_read_key() { return 0; }
+void Terminal::ansi_resize() { }
+
+// Sets up the terminal for the ANSI backend. Returns false if the backend can't be used.
+bool Terminal::ansi_init()
+{
+    core()->guru()->nonfatal("The ANSI terminal backend is not available on Windows.", GURU_WARN);
+    return false;
+}
+
+#else   // INVICTUS_TARGET_WINDOWS
+
+namespace
+{
+
+bool            ansi_active = false;        // Has the terminal been set up for the ANSI backend?
+int             ansi_resize_pipe[2] = {-1, -1}; // The SIGWINCH handler writes to this, so that ansi_read_key() can notice the terminal being resized.
+struct termios  ansi_termios_old;           // The terminal's settings before the ANSI backend changed them.
+
+// Called when the terminal is resized. Only async-signal-safe functions can be used here, so it just wakes up ansi_read_key().
+void ansi_sigwinch(int)
+{
+    const int old_errno = errno;
+    const char byte = 0;
+    if (write(ansi_resize_pipe[1], &byte, 1) < 0) { }
+    errno = old_errno;
+}
+
+// Writes a string to the terminal, in as few write() calls as it takes.
+void ansi_write(const std::string &str)
+{
+    size_t written = 0;
+    while (written < str.size())
+    {
+        const ssize_t result = write(STDOUT_FILENO, str.data() + written, str.size() - written);
+        if (result < 0)
+        {
+            if (errno == EINTR) continue;
+            return;
+        }
+        written += result;
+    }
+}
+
+}   // anonymous namespace
+
+
+// Restores the terminal to its former state, after the ANSI backend has been using it.
+void Terminal::ansi_cleanup()
+{
+    if (!ansi_active) return;
+    ansi_active = false;
+    signal(SIGWINCH, SIG_DFL);
+    ansi_write("\x1b[0m\x1b[?25h\x1b[?1049l");  // Resets the colours, shows the cursor, and leaves the alternate screen.
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &ansi_termios_old);
+    close(ansi_resize_pipe[0]);
+    close(ansi_resize_pipe[1]);
+}
+
+// Draws everything that's changed on the screen since the last update, with the ANSI backend.
+void Terminal::ansi_flip()
+{
+    // Build up the whole frame first: the screen itself, with every visible Window on top, from the bottom up.
+    ansi_frame_ = ansi_screen_;
+    for (auto window : Window::stack_)
+    {
+        if (!window->visible_) continue;
+        for (int y = 0; y < window->height_; y++)
+        {
+            const int screen_y = y + window->y_;
+            if (screen_y < 0) continue;
+            if (screen_y >= ansi_rows_) break;
+            for (int x = 0; x < window->width_; x++)
+            {
+                const int screen_x = x + window->x_;
+                if (screen_x < 0) continue;
+                if (screen_x >= ansi_cols_) break;
+                ansi_frame_[screen_x + (screen_y * ansi_cols_)] = window->front_[x + (y * window->width_)];
+            }
+        }
+    }
+
+    // Now send only the cells which have changed. The cursor only needs moving when skipping over cells that haven't, and the colour only needs setting
+    // when it's different from the last cell sent.
+    const uint8_t acs_flags = core()->prefs()->acs_flags();
+    std::string output, sgr, last_sgr;
+    int cursor_x = -1, cursor_y = -1;
+    for (int y = 0; y < ansi_rows_; y++)
+    {
+        for (int x = 0; x < ansi_cols_; x++)
+        {
+            const int index = x + (y * ansi_cols_);
+            const ScreenCell &cell = ansi_frame_[index];
+            if (cell == ansi_sent_[index]) continue;
+            if (x != cursor_x || y != cursor_y) output += "\x1b[" + std::to_string(y + 1) + ";" + std::to_string(x + 1) + "H";
+
+            const bool glyph = (cell.letter >= 256 && cell.letter <= 287);
+            const bool unprintable = (!glyph && (cell.letter < ' ' || cell.letter > '~'));
+            sgr = ansi_sgr(cell.colour, cell.flags, unprintable);
+            if (sgr != last_sgr)
+            {
+                output += sgr;
+                last_sgr = sgr;
+            }
+            if (glyph)
+            {
+                const AnsiGlyph &ansi_glyph = ansi_glyphs[cell.letter - 256];
+                if ((acs_flags & ansi_glyph.acs_flag) == ansi_glyph.acs_flag) output += ansi_glyph.utf8;
+                else output += ansi_glyph.ascii;
+            }
+            else if (unprintable) output += '?';
+            else output += static_cast<char>(cell.letter);
+
+            // After writing in the last column, terminals don't agree on where the cursor ends up, so it's safest to move it explicitly next time.
+            if (x + 1 < ansi_cols_)
+            {
+                cursor_x = x + 1;
+                cursor_y = y;
+            }
+            else cursor_x = cursor_y = -1;
+        }
+    }
+    ansi_sent_.swap(ansi_frame_);
+    if (output.size()) ansi_write(output);
+}
+
+// Sets up the terminal for the ANSI backend. Returns false if the backend can't be used.
+bool Terminal::ansi_init()
+{
+    auto guru = core()->guru();
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO))
+    {
+        guru->nonfatal("The ANSI terminal backend needs an interactive terminal.", GURU_WARN);
+        return false;
+    }
+    if (tcgetattr(STDIN_FILENO, &ansi_termios_old) < 0 || pipe(ansi_resize_pipe) < 0)
+    {
+        guru->nonfatal("Could not set up the ANSI terminal backend.", GURU_WARN);
+        return false;
+    }
+    for (int i = 0; i < 2; i++)
+        fcntl(ansi_resize_pipe[i], F_SETFL, fcntl(ansi_resize_pipe[i], F_GETFL) | O_NONBLOCK);
+
+    // Turn off line buffering and echo, and let ^C arrive as a keypress, so that it can shut the game down cleanly as it does with Curses.
+    struct termios raw = ansi_termios_old;
+    raw.c_iflag &= ~(IXON);
+    raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+
+    struct sigaction action = {};
+    action.sa_handler = ansi_sigwinch;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGWINCH, &action, nullptr);
+
+    has_colour_ = core()->prefs()->use_colour();
+    ansi_active = true;
+    ansi_write("\x1b[?1049h\x1b[?25l");  // Switches to the alternate screen, and hides the cursor.
+    ansi_resize();
+    return true;
+}
+
+// Reads a keypress directly from the terminal, and converts it into a key code.
+int Terminal::ansi_read_key()
+{
+    if (core()->guru()) core()->guru()->check_stderr();
+    escape_key_string_.clear();
+
+    // Wait for either a keypress, or the terminal being resized.
+    struct pollfd fds[2] = { { STDIN_FILENO, POLLIN, 0 }, { ansi_resize_pipe[0], POLLIN, 0 } };
+    unsigned char byte = 0;
+    while (true)
+    {
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR) continue;
+            core()->guru()->halt("Could not read from the terminal.");
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            char drain[16];
+            while (read(ansi_resize_pipe[0], drain, sizeof(drain)) > 0) { }
+            ansi_resize();
+            key_raw_ = Key::RESIZE;
+            return Key::RESIZE;
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            const ssize_t result = read(STDIN_FILENO, &byte, 1);
+            if (result == 1) break;
+            if (result < 0 && errno == EINTR) continue;
+            core()->cleanup();  // The terminal has gone away, so there's nothing else to do but exit.
+            exit(EXIT_SUCCESS);
+        }
+    }
+    key_raw_ = byte;
+
+    // Any further bytes read after the escape key that arrive in time are part of an escape sequence.
+    auto next_byte = [&byte](int timeout) -> bool {
+        struct pollfd stdin_fd = { STDIN_FILENO, POLLIN, 0 };
+        return (poll(&stdin_fd, 1, timeout) > 0 && read(STDIN_FILENO, &byte, 1) == 1);
+    };
+    if (key_raw_ == Key::ESCAPE)
+    {
+        escape_key_string_ = "\x1b";
+        while (next_byte(ANSI_ESCAPE_TIMEOUT) && byte != Key::ESCAPE)
+            escape_key_string_ += static_cast<char>(byte);
+        if (escape_key_string_.size() == 1) return Key::ESCAPE;
+        auto result = escape_code_index_.find(escape_key_string_);
+        if (result == escape_code_index_.end())
+        {
+            core()->guru()->log("Unknown escape keycode: " + escape_key_string_);
+            return Key::UNKNOWN_ESCAPE_SEQUENCE;
+        }
+        else return result->second;
+    }
+
+    // The pound and not signs are the only non-ASCII keys the game uses; anything else in UTF-8 is just read and discarded.
+    if (key_raw_ >= 0x80)
+    {
+        uint32_t code_point = 0;
+        int continuation = 0;
+        if ((key_raw_ & 0xE0) == 0xC0) { code_point = key_raw_ & 0x1F; continuation = 1; }
+        else if ((key_raw_ & 0xF0) == 0xE0) { code_point = key_raw_ & 0x0F; continuation = 2; }
+        else if ((key_raw_ & 0xF8) == 0xF0) { code_point = key_raw_ & 0x07; continuation = 3; }
+        while (continuation-- > 0 && next_byte(ANSI_ESCAPE_TIMEOUT))
+            code_point = (code_point << 6) | (byte & 0x3F);
+        key_raw_ = code_point;
+        if (code_point == 0xA3) return Key::POUND;
+        else if (code_point == 0xAC) return Key::NOT;
+        else return Key::UNKNOWN_KEY;
+    }
+
+    if ((key_raw_ >= 4 && key_raw_ <= 26) || (key_raw_ >= ' ' && key_raw_ <= '~')) return key_raw_;
+    else switch(key_raw_)
+    {
+        case 1: case 2: return key_raw_;
+        case 3:
+            core()->cleanup();
+            exit(EXIT_SUCCESS);
+        case 127: return Key::BACKSPACE;
+        default: return Key::UNKNOWN_KEY;
+    }
+}
+
+// Checks the terminal's size, and resizes the screen buffers to match.
+void Terminal::ansi_resize()
+{
+    struct winsize size = {};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) < 0 || !size.ws_col || !size.ws_row)
+    {
+        // If the terminal won't say how big it is, just assume the classic size.
+        size.ws_col = 80;
+        size.ws_row = 24;
+    }
+    ansi_cols_ = size.ws_col;
+    ansi_rows_ = size.ws_row;
+
+    // Whatever was on the screen before can't be trusted any more, so the whole thing is cleared, and redrawn on the next update.
+    ansi_screen_.assign(ansi_cols_ * ansi_rows_, ANSI_BLANK_CELL);
+    ansi_sent_.assign(ansi_cols_ * ansi_rows_, ANSI_UNKNOWN_CELL);
+    ansi_write("\x1b[0m\x1b[2J");
+}
+
+#endif  // INVICTUS_TARGET_WINDOWS
+
+}   // namespace invictus
@@ -29,6 +29,20 @@ enum class Colour : uint8_t { NONE, BLACK, BLACK_BOLD, RED, RED_BOLD, GREEN, GRE
 enum class Glyph : uint16_t { ULCORNER = 256, LLCORNER, URCORNER, LRCORNER, RTEE, LTEE, BTEE, TTEE, HLINE, VLINE, PLUS, S1, S9, DIAMOND, CKBOARD, DEGREE,
     PLMINUS, BULLET, LARROW, RARROW, DARROW, UARROW, BOARD, LANTERN, BLOCK, S3, S7, LEQUAL, GEQUAL, PI, NEQUAL, STERLING };
 
+// The ways the Terminal can draw to the screen: through Curses by default, or with the ANSI backend, which writes escape sequences straight to the terminal
+// (Linux/MacOS only).
+enum class TerminalBackend : uint8_t { DEFAULT, ANSI };
+
+// A single character cell on the screen, or in a Window.
+struct ScreenCell
+{
+    uint32_t    letter; // The character in this cell, or a Glyph.
+    Colour      colour; // The colour of this cell.
+    uint8_t     flags;  // Any PRINT_FLAG_* flags on this cell.
+
+    bool        operator==(const ScreenCell &other) const { return letter == other.letter && colour == other.colour && flags == other.flags; }
+};
+
 enum Key { BACKSPACE = 8, TAB = 9, ENTER = 10, CR = 13, ESCAPE = 27, RESIZE = 256, ARROW_UP, ARROW_DOWN, ARROW_LEFT, ARROW_RIGHT, DELETE, INSERT, HOME, END,
     PAGE_UP, PAGE_DOWN, F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12, KP0, KP1, KP2, KP3, KP4, KP5, KP6, KP7, KP8, KP9, POUND, NOT, UNKNOWN_KEY,
     UNKNOWN_ESCAPE_SEQUENCE };
@@ -1,26 +1,57 @@
 // core/terminal.cpp -- Interface code to PDCurses/NCurses, to handle cross-platform compatability and generally take away the pain of using Curses' API.
 // Copyright © 2019, 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
 
+#include <algorithm>
+
 #include <curses.h>
 #include <panel.h>
 
+#ifndef INVICTUS_TARGET_WINDOWS
+#include <termios.h>
+#include <unistd.h>
+#endif
+
 #include "core/core.hpp"
 #include "core/guru.hpp"
 #include "core/prefs.hpp"
+#include "core/replay.hpp"
 #include "core/version.hpp"
+#include "terminal/styled-text.hpp"
 #include "terminal/terminal.hpp"
 #include "terminal/window.hpp"
+#include "tune/headless.hpp"
 
 
 namespace invictus
 {
 
+bool Terminal::ansi_ = false;           // Is the terminal using the ANSI backend, rather than Curses?
 bool Terminal::cleanup_done_ = false;   // Has the cleanup routine already run once?
+bool Terminal::headless_ = false;       // Is the terminal running in headless mode, with no Curses at all?
 
 
-// Sets up the Curses terminal.
-Terminal::Terminal() : cursor_state_(1), has_colour_(false), initialized_(false), key_raw_(0)
+// Sets up the Curses terminal, or a null terminal which draws nothing, for headless mode.
+Terminal::Terminal(bool headless) : ansi_cols_(0), ansi_rows_(0), cursor_state_(1), has_colour_(false), initialized_(false), key_raw_(0)
 {
+    headless_ = headless;
+    if (headless_)
+    {
+        // Without Curses, the console is never marked as ready, so Guru will print any critical errors to stdout instead.
+        core()->guru()->log("Headless terminal is up and running.");
+        initialized_ = true;
+        return;
+    }
+
+    // The ANSI backend talks to the terminal directly. If it can't be used for whatever reason, we just fall back on Curses.
+    if (core()->prefs()->terminal_backend() == TerminalBackend::ANSI && ansi_init())
+    {
+        ansi_ = true;
+        core()->guru()->console_ready(true);
+        core()->guru()->log("ANSI terminal is up and running.");
+        initialized_ = true;
+        return;
+    }
+
     initscr();  // Curses initialization
     cbreak();   // Disable line-buffering.
     if (core()->prefs()->use_colour() && has_colors())
@@ -63,9 +94,33 @@ Terminal::Terminal() : cursor_state_(1), has_colour_(false), initialized_(false)
 // Destructor, calls cleanup code.
 Terminal::~Terminal() { cleanup(); }
 
+// Checks if the terminal is using the ANSI backend, which writes escape sequences directly instead of using Curses.
+bool Terminal::ansi() { return ansi_; }
+
 // Draws a box around the edge of a Window.
 void Terminal::box(std::shared_ptr<Window> window, Colour colour, unsigned int flags)
 {
+    if (headless_) return;
+    if (ansi_)
+    {
+        // Glyphs fall back on ASCII by themselves, if the ACS box-drawing characters aren't enabled.
+        const int right = get_cols(window) - 1, bottom = get_rows(window) - 1;
+        for (int x = 1; x < right; x++)
+        {
+            put(Glyph::HLINE, x, 0, colour, flags, window);
+            put(Glyph::HLINE, x, bottom, colour, flags, window);
+        }
+        for (int y = 1; y < bottom; y++)
+        {
+            put(Glyph::VLINE, 0, y, colour, flags, window);
+            put(Glyph::VLINE, right, y, colour, flags, window);
+        }
+        put(Glyph::ULCORNER, 0, 0, colour, flags, window);
+        put(Glyph::URCORNER, right, 0, colour, flags, window);
+        put(Glyph::LLCORNER, 0, bottom, colour, flags, window);
+        put(Glyph::LRCORNER, right, bottom, colour, flags, window);
+        return;
+    }
     WINDOW *win = (window ? window->win() : stdscr);
     bool bold = ((flags & PRINT_FLAG_BOLD) == PRINT_FLAG_BOLD);
     bool reverse = ((flags & PRINT_FLAG_REVERSE) == PRINT_FLAG_REVERSE);
@@ -92,13 +147,20 @@ void Terminal::box(std::shared_ptr<Window> window, Colour colour, unsigned int f
 void Terminal::cleanup()
 {
     if (cleanup_done_) return;
+    cleanup_done_ = true;
+    if (headless_) return;
+    if (ansi_)
+    {
+        if (core() && core()->guru()) core()->guru()->log("Cleaning up ANSI terminal.");
+        ansi_cleanup();
+        return;
+    }
     if (core() && core()->guru()) core()->guru()->log("Cleaning up Curses terminal.");
     echo();                 // Re-enables keyboard input being printed to the screen (normal console behaviour)
     keypad(stdscr, false);  // Disables the numeric keypad (it's off by default)
     curs_set(1);            // Re-enables the blinking cursor
     nocbreak();             // Re-enables line buffering.
     endwin();               // Cleans up Curses internally.
-    cleanup_done_ = true;
 }
 
 // Clears the current line.
@@ -111,6 +173,13 @@ void clear_line(std::shared_ptr<Window> window)
 // Clears the screen.
 void Terminal::cls(std::shared_ptr<Window> window)
 {
+    if (headless_) return;
+    if (ansi_)
+    {
+        std::vector<ScreenCell> &cells = (window ? window->front_ : ansi_screen_);
+        std::fill(cells.begin(), cells.end(), ScreenCell({' ', Colour::NONE, 0}));
+        return;
+    }
     if (!window) erase();
     else werase(window->win());
 }
@@ -153,23 +222,73 @@ unsigned long Terminal::colour_pair_code(Colour col, uint32_t flags)
 // Updates the screen.
 void Terminal::flip()
 {
+    if (headless_) return;
+    if (ansi_)
+    {
+        ansi_flip();
+        return;
+    }
     update_panels();
     doupdate();
 }
 
 // Flushes the input buffer.
-void Terminal::flush() { flushinp(); }
+void Terminal::flush()
+{
+    if (headless_) return;
+    if (ansi_)
+    {
+#ifndef INVICTUS_TARGET_WINDOWS
+        tcflush(STDIN_FILENO, TCIFLUSH);
+#endif
+    }
+    else flushinp();
+}
+
+// Sends any cells in a Window's framebuffer which have changed since the last flush to Curses.
+void Terminal::flush_cells(std::shared_ptr<Window> window)
+{
+    if (headless_ || window->back_.empty()) return;
+    if (ansi_)
+    {
+        // The ANSI backend has no Curses window to send the cells to; the Window's contents are whatever was drawn into it last.
+        window->front_ = window->back_;
+        return;
+    }
+    WINDOW *win = window->win();
+    const int width = window->get_width(), height = window->get_height();
+    const uint8_t acs_flags = core()->prefs()->acs_flags();
+
+    // Each run of changed cells on a row only needs the cursor moving once, as Curses moves it along as each character is drawn.
+    for (int y = 0; y < height; y++)
+    {
+        int next_x = -1;
+        for (int x = 0; x < width; x++)
+        {
+            const int index = x + (y * width);
+            const ScreenCell &cell = window->back_[index];
+            if (cell == window->front_[index]) continue;
+            if (x != next_x) wmove(win, y, x);
+            waddch(win, glyph_code(cell.letter, cell.colour, cell.flags, acs_flags));
+            window->front_[index] = cell;
+            next_x = x + 1;
+        }
+    }
+}
 
 // Gets the number of columns available on the screen right now.
 uint16_t Terminal::get_cols(std::shared_ptr<Window> window)
 {
     if (window) return window->get_width();
+    else if (headless_) return HEADLESS_SCREEN_COLS;
+    else if (ansi_) return ansi_cols_;
     else return getmaxx(stdscr);
 }
 
 // Gets the current cursor X coordinate.
 uint16_t Terminal::get_cursor_x(std::shared_ptr<Window> window)
 {
+    if (headless_ || ansi_) return 0;
     WINDOW *win = (window ? window->win() : stdscr);
     return getcurx(win);
 }
@@ -177,6 +296,7 @@ uint16_t Terminal::get_cursor_x(std::shared_ptr<Window> window)
 // Gets the current cursor Y coordinate.
 uint16_t Terminal::get_cursor_y(std::shared_ptr<Window> window)
 {
+    if (headless_ || ansi_) return 0;
     WINDOW *win = (window ? window->win() : stdscr);
     return getcury(win);
 }
@@ -185,100 +305,29 @@ uint16_t Terminal::get_cursor_y(std::shared_ptr<Window> window)
 int Terminal::get_key(std::shared_ptr<Window> window)
 {
     if (!initialized_ || cleanup_done_) return 0;
-    WINDOW *win = (window ? window->win() : stdscr);
-    if (core()->guru()) core()->guru()->check_stderr();
-    key_raw_ = wgetch(win);
-    escape_key_string_.clear();
-
-    if (key_raw_ == Key::ESCAPE)
+    int key;
+    if (key_source_)
     {
-        escape_key_string_ = "\x1b";
-        nodelay(win, true);
-        do
-        {
-            key_raw_ = wgetch(win);
-            if (key_raw_ > 0 && key_raw_ != Key::ESCAPE) escape_key_string_ += std::string(1, static_cast<char>(key_raw_));
-        } while (key_raw_ > 0);
-        nodelay(win, false);
-        if (escape_key_string_.size() == 1)
-        {
-            key_raw_ = Key::ESCAPE;
-            return Key::ESCAPE;
-        }
-        auto result = escape_code_index_.find(escape_key_string_);
-        if (result == escape_code_index_.end())
-        {
-            core()->guru()->log("Unknown escape keycode: " + escape_key_string_);
-            return Key::UNKNOWN_ESCAPE_SEQUENCE;
-        }
-        else return result->second;
+        key = key_raw_ = key_source_();
+        escape_key_string_.clear();
     }
-
-    if ((key_raw_ >= 4 && key_raw_ <= 26) || (key_raw_ >= ' ' && key_raw_ <= '~')) return key_raw_;
-    else switch(key_raw_)
+    else if (headless_)
     {
-        case KEY_RESIZE:    // Window resized event.
-        {
-            resize_term(0, 0);
-            curs_set(cursor_state_);
-            return Key::RESIZE;
-        }
-        case 1: case 2: return key_raw_;
-        case 3: case 0x130:
-            core()->cleanup();
-            exit(EXIT_SUCCESS);
-        case KEY_BACKSPACE: return Key::BACKSPACE;
-        case KEY_DC: return Key::DELETE;
-        case KEY_DOWN: return Key::ARROW_DOWN;
-        case KEY_END: return Key::END;
-        case KEY_ENTER: return Key::ENTER;
-        case KEY_F0 + 1: return Key::F1;
-        case KEY_F0 + 2: return Key::F2;
-        case KEY_F0 + 3: return Key::F3;
-        case KEY_F0 + 4: return Key::F4;
-        case KEY_F0 + 5: return Key::F5;
-        case KEY_F0 + 6: return Key::F6;
-        case KEY_F0 + 7: return Key::F7;
-        case KEY_F0 + 8: return Key::F8;
-        case KEY_F0 + 9: return Key::F9;
-        case KEY_F0 + 10: return Key::F10;
-        case KEY_F0 + 11: return Key::F11;
-        case KEY_F0 + 12: return Key::F12;
-        case KEY_HOME: return Key::HOME;
-        case KEY_IC: return Key::INSERT;
-        case KEY_LEFT: return Key::ARROW_LEFT;
-        case KEY_NPAGE: return Key::PAGE_DOWN;
-        case KEY_PPAGE: return Key::PAGE_UP;
-        case KEY_RIGHT: return Key::ARROW_RIGHT;
-        case KEY_UP: return Key::ARROW_UP;
-        case 0xA3: return Key::POUND;
-        case 0xAC: return Key::NOT;
-#ifdef INVICTUS_TARGET_WINDOWS
-        case KEY_A1: return Key::KP7;
-        case KEY_A2: return Key::KP8;
-        case KEY_A3: return Key::KP9;
-        case KEY_B1: return Key::KP4;
-        case KEY_B2: return Key::KP5;
-        case KEY_B3: return Key::KP6;
-        case KEY_C1: return Key::KP1;
-        case KEY_C2: return Key::KP2;
-        case KEY_C3: return Key::KP3;
-        case PAD0: return Key::KP0;
-        case PADENTER: return Key::ENTER;
-        case PADSTOP: return '.';
-        case PADMINUS: return '-';
-        case PADPLUS: return '+';
-        case PADSLASH: return '/';
-        case PADSTAR: return '*';
-#endif
-        default: return Key::UNKNOWN_KEY;
+        core()->guru()->halt("Headless terminal has no source of keypresses!");
+        return 0;
     }
+    else if (ansi_) key = ansi_read_key();
+    else key = read_key(window);
+    Replay::record_key(key);
+    return key;
 }
 
 // Gets the central column of the specified Window.
 uint16_t Terminal::get_midcol(std::shared_ptr<Window> window)
 {
     if (window) return window->get_width() / 2;
+    else if (headless_) return HEADLESS_SCREEN_COLS / 2;
+    else if (ansi_) return ansi_cols_ / 2;
     else return getmaxx(stdscr) / 2;
 }
 
@@ -286,6 +335,8 @@ uint16_t Terminal::get_midcol(std::shared_ptr<Window> window)
 uint16_t Terminal::get_midrow(std::shared_ptr<Window> window)
 {
     if (window) return window->get_height() / 2;
+    else if (headless_) return HEADLESS_SCREEN_ROWS / 2;
+    else if (ansi_) return ansi_rows_ / 2;
     else return getmaxy(stdscr) / 2;
 }
 
@@ -293,6 +344,8 @@ uint16_t Terminal::get_midrow(std::shared_ptr<Window> window)
 uint16_t Terminal::get_rows(std::shared_ptr<Window> window)
 {
     if (window) return window->get_height();
+    else if (headless_) return HEADLESS_SCREEN_ROWS;
+    else if (ansi_) return ansi_rows_;
     else return getmaxy(stdscr);
 }
 
@@ -305,121 +358,9 @@ std::string get_string(std::shared_ptr<Window> window)
     return buffer;
 }
 
-// Retrieves the last escape-key sequence processed by get_key().
-std::string Terminal::last_escape_sequence() const { return escape_key_string_; }
-
-// The raw, unprocessed value of the last key processed by get_key().
-int Terminal::last_key_raw() const { return key_raw_; }
-
-// Moves the cursor to the given coordinates; -1 for either coordinate retains its current position on that axis.
-void Terminal::move_cursor(int x, int y, std::shared_ptr<Window> window)
-{
-    if (x == -1 && y == -1) return;
-    WINDOW *win = (window ? window->win() : stdscr);
-    const int old_x = get_cursor_x(window);
-    const int old_y = get_cursor_y(window);
-    if (x == -1) x = old_x;
-    if (y == -1) y = old_y;
-    wmove(win, y, x);
-}
-
-// Prints a string at a given coordinate on the screen.
-void Terminal::print(std::string str, int x, int y, Colour col, unsigned int flags, std::shared_ptr<Window> window)
-{
-    if (!str.size()) return;
-    WINDOW *win = (window ? window->win() : stdscr);
-
-    int window_w, window_h;
-    if (window) { window_w = window->get_width(); window_h = window->get_height(); }
-    else { window_w = get_cols(); window_h = get_rows(); }
-    if (x < 0 || x >= window_w || y < 0 || y >= window_h) return;
-    
-    bool bold = (flags & PRINT_FLAG_BOLD) == PRINT_FLAG_BOLD;
-    bool reverse = (flags & PRINT_FLAG_REVERSE) == PRINT_FLAG_REVERSE;
-    bool blink = (flags & PRINT_FLAG_BLINK) == PRINT_FLAG_BLINK;
-
-    if (col == Colour::BLACK_BOLD && reverse)
-    {
-        col = Colour::WHITE;
-        bold = false;
-    }
-
-    unsigned int colour_flags = 0;    
-    if (bold) colour_flags |= A_BOLD;
-    if (reverse) colour_flags |= A_REVERSE;
-    if (blink) colour_flags |= A_BLINK;
-
-    if (str.find("{") == std::string::npos)
-    {
-        // If no colour codes are present, this is fairly easy.
-        const unsigned long ansi_code = colour_pair_code(col, flags);
-        if (has_colour_) wattron(win, ansi_code | colour_flags);
-        mvwprintw(win, y, x, "%s", str.c_str());
-        if (has_colour_) wattroff(win, ansi_code | colour_flags);
-        return;
-    }
-
-    // Colour codes need to be parsed. Curses doesn't support multiple colour codes in a single printw(), so we're gonna have to get creative.
-
-    if (str[0] != '{') str = "{w}" + str;   // If there isn't a colour tag specified at the start, start it with white.
-
-    while (str.size())
-    {
-        std::string first_word;
-        size_t tag_pos = str.substr(1).find_first_of('{');  // We skip ahead one char, to ignore the opening brace. We want to find the *next* opening brace.
-        if (tag_pos != std::string::npos)
-        {
-            first_word = str.substr(0, tag_pos + 1);
-            str = str.substr(tag_pos + 1);
-        }
-        else
-        {
-            first_word = str;
-            str = "";
-        }
-
-        while (first_word.size() >= 3 && first_word[0] == '{' && first_word[2] == '}')
-        {
-            const std::string tag = first_word.substr(0, 3);
-            first_word = first_word.substr(3);
-            switch(tag[1])
-            {
-                case 'b': col = Colour::BLACK; break;
-                case 'B': col = (reverse ? Colour::WHITE : Colour::BLACK_BOLD); break;
-                case 'r': col = Colour::RED; break;
-                case 'R': col = Colour::RED_BOLD; break;
-                case 'g': col = Colour::GREEN; break;
-                case 'G': col = Colour::GREEN_BOLD; break;
-                case 'y': col = Colour::YELLOW; break;
-                case 'Y': col = Colour::YELLOW_BOLD; break;
-                case 'u': col = Colour::BLUE; break;
-                case 'U': col = Colour::BLUE_BOLD; break;
-                case 'm': col = Colour::MAGENTA; break;
-                case 'M': col = Colour::MAGENTA_BOLD; break;
-                case 'c': col = Colour::CYAN; break;
-                case 'C': col = Colour::CYAN_BOLD; break;
-                case 'w': col = Colour::WHITE; break;
-                case 'W': col = Colour::WHITE_BOLD; break;
-            }
-        }
-
-        const unsigned long ansi_code = colour_pair_code(col, flags);
-        if (has_colour_) wattron(win, ansi_code | colour_flags);
-        const unsigned int first_word_size = first_word.size();
-        mvwprintw(win, y, x, "%s", first_word.c_str());
-        if (has_colour_) wattroff(win, ansi_code | colour_flags);
-        x += first_word_size;
-    }
-}
-
-// Prints a character at a given coordinate on the screen.
-void Terminal::put(uint32_t letter, int x, int y, Colour col, unsigned int flags, std::shared_ptr<Window> window)
+// Converts a character, with its colour and print flags, into a Curses character code.
+unsigned long Terminal::glyph_code(uint32_t letter, Colour col, unsigned int flags, uint8_t acs_flags)
 {
-    int window_w, window_h;
-    if (window) { window_w = window->get_width(); window_h = window->get_height(); }
-    else { window_w = get_cols(); window_h = get_rows(); }
-    if (x < 0 || x >= window_w || y < 0 || y >= window_h) return;
-
     bool bold = (flags & PRINT_FLAG_BOLD) == PRINT_FLAG_BOLD;
     bool reverse = (flags & PRINT_FLAG_REVERSE) == PRINT_FLAG_REVERSE;
     bool blink = (flags & PRINT_FLAG_BLINK) == PRINT_FLAG_BLINK;
@@ -435,8 +376,6 @@ void Terminal::put(uint32_t letter, int x, int y, Colour col, unsigned int flags
     if (reverse) colour_flags |= A_REVERSE;
     if (blink) colour_flags |= A_BLINK;
 
-    WINDOW *win = (window ? window->win() : stdscr);
-    uint8_t acs_flags = core()->prefs()->acs_flags();
     const bool acs_box = ((acs_flags & 1) == 1);
     const bool acs_vt100 = ((acs_flags & 2) == 2);
     const bool acs_teletype = ((acs_flags & 4) == 4);
@@ -487,19 +426,211 @@ void Terminal::put(uint32_t letter, int x, int y, Colour col, unsigned int flags
         colour_flags |= A_REVERSE | A_BLINK | A_BOLD;
     }
     
-    const unsigned long ansi_code = colour_pair_code(col, flags);
-    if (has_colour_) wattron(win, ansi_code | colour_flags);
-    mvwaddch(win, y, x, letter);
-    if (has_colour_) wattroff(win, ansi_code | colour_flags);
+    if (!has_colour_) return letter;
+    return letter | colour_pair_code(col, flags) | colour_flags;
+}
+
+
+// Checks if the terminal is running in headless mode, without Curses.
+bool Terminal::headless() { return headless_; }
+
+// Retrieves the last escape-key sequence processed by get_key().
+std::string Terminal::last_escape_sequence() const { return escape_key_string_; }
+
+// The raw, unprocessed value of the last key processed by get_key().
+int Terminal::last_key_raw() const { return key_raw_; }
+
+// Moves the cursor to the given coordinates; -1 for either coordinate retains its current position on that axis.
+void Terminal::move_cursor(int x, int y, std::shared_ptr<Window> window)
+{
+    if (headless_ || ansi_ || (x == -1 && y == -1)) return;
+    WINDOW *win = (window ? window->win() : stdscr);
+    const int old_x = get_cursor_x(window);
+    const int old_y = get_cursor_y(window);
+    if (x == -1) x = old_x;
+    if (y == -1) y = old_y;
+    wmove(win, y, x);
+}
+
+// Prints a string at a given coordinate on the screen.
+void Terminal::print(std::string str, int x, int y, Colour col, unsigned int flags, std::shared_ptr<Window> window)
+{
+    if (headless_ || !str.size()) return;
+    print(StyledText(str), x, y, col, flags, window);
+}
+
+// As above, but prints text with its colour tags already parsed. Optionally, only part of the text is printed, such as a single line of wrapped text.
+void Terminal::print(const StyledText &text, int x, int y, Colour col, unsigned int flags, std::shared_ptr<Window> window, uint32_t start, uint32_t length)
+{
+    if (headless_ || start >= text.length()) return;
+    if (length > text.length() - start) length = text.length() - start;
+    WINDOW *win = (ansi_ ? nullptr : (window ? window->win() : stdscr));
+
+    int window_w, window_h;
+    if (window) { window_w = window->get_width(); window_h = window->get_height(); }
+    else { window_w = get_cols(); window_h = get_rows(); }
+    if (x < 0 || x >= window_w || y < 0 || y >= window_h) return;
+    
+    bool bold = (flags & PRINT_FLAG_BOLD) == PRINT_FLAG_BOLD;
+    bool reverse = (flags & PRINT_FLAG_REVERSE) == PRINT_FLAG_REVERSE;
+    bool blink = (flags & PRINT_FLAG_BLINK) == PRINT_FLAG_BLINK;
+
+    if (col == Colour::BLACK_BOLD && reverse)
+    {
+        col = Colour::WHITE;
+        bold = false;
+    }
+
+    // The ANSI backend works out each cell's attributes when it's drawn, but still needs to know if bold was turned off above.
+    if (ansi_ && !bold) flags &= ~PRINT_FLAG_BOLD;
+
+    unsigned int colour_flags = 0;    
+    if (bold) colour_flags |= A_BOLD;
+    if (reverse) colour_flags |= A_REVERSE;
+    if (blink) colour_flags |= A_BLINK;
+
+    // Curses doesn't support multiple colours in a single printw(), so each colour span is printed separately.
+    const std::string &plain = text.text();
+    for (auto &span : text.spans())
+    {
+        const uint32_t from = std::max(span.offset, start), to = std::min(span.offset + span.length, start + length);
+        if (from >= to) continue;
+        Colour span_col = (span.tagged ? span.colour : col);
+        if (span_col == Colour::BLACK_BOLD && reverse) span_col = Colour::WHITE;
+        const int span_x = x + from - start;
+
+        if (ansi_)
+        {
+            for (uint32_t i = from; i < to; i++)
+                put(static_cast<unsigned char>(plain[i]), span_x + i - from, y, span_col, flags, window);
+            continue;
+        }
+        const unsigned long ansi_code = colour_pair_code(span_col, flags);
+        if (has_colour_) wattron(win, ansi_code | colour_flags);
+        mvwaddnstr(win, y, span_x, plain.data() + from, to - from);
+        if (has_colour_) wattroff(win, ansi_code | colour_flags);
+    }
+}
+
+// Prints a character at a given coordinate on the screen.
+void Terminal::put(uint32_t letter, int x, int y, Colour col, unsigned int flags, std::shared_ptr<Window> window)
+{
+    if (headless_) return;
+    int window_w, window_h;
+    if (window) { window_w = window->get_width(); window_h = window->get_height(); }
+    else { window_w = get_cols(); window_h = get_rows(); }
+    if (x < 0 || x >= window_w || y < 0 || y >= window_h) return;
+
+    if (ansi_)
+    {
+        *ansi_cell(window, x, y) = {letter, col, static_cast<uint8_t>(flags)};
+        return;
+    }
+    WINDOW *win = (window ? window->win() : stdscr);
+    mvwaddch(win, y, x, glyph_code(letter, col, flags, core()->prefs()->acs_flags()));
 }
 
 // As above, but a wrapper to allow use of the Glyph enum.
 void Terminal::put(Glyph letter, int x, int y, Colour col, unsigned int flags, std::shared_ptr<Window> window)
 { put(static_cast<uint32_t>(letter), x, y, col, flags, window); }
 
+// Reads a keypress from Curses, and converts it into a key code.
+int Terminal::read_key(std::shared_ptr<Window> window)
+{
+    WINDOW *win = (window ? window->win() : stdscr);
+    if (core()->guru()) core()->guru()->check_stderr();
+    key_raw_ = wgetch(win);
+    escape_key_string_.clear();
+
+    if (key_raw_ == Key::ESCAPE)
+    {
+        escape_key_string_ = "\x1b";
+        nodelay(win, true);
+        do
+        {
+            key_raw_ = wgetch(win);
+            if (key_raw_ > 0 && key_raw_ != Key::ESCAPE) escape_key_string_ += std::string(1, static_cast<char>(key_raw_));
+        } while (key_raw_ > 0);
+        nodelay(win, false);
+        if (escape_key_string_.size() == 1)
+        {
+            key_raw_ = Key::ESCAPE;
+            return Key::ESCAPE;
+        }
+        auto result = escape_code_index_.find(escape_key_string_);
+        if (result == escape_code_index_.end())
+        {
+            core()->guru()->log("Unknown escape keycode: " + escape_key_string_);
+            return Key::UNKNOWN_ESCAPE_SEQUENCE;
+        }
+        else return result->second;
+    }
+
+    if ((key_raw_ >= 4 && key_raw_ <= 26) || (key_raw_ >= ' ' && key_raw_ <= '~')) return key_raw_;
+    else switch(key_raw_)
+    {
+        case KEY_RESIZE:    // Window resized event.
+        {
+            resize_term(0, 0);
+            curs_set(cursor_state_);
+            return Key::RESIZE;
+        }
+        case 1: case 2: return key_raw_;
+        case 3: case 0x130:
+            core()->cleanup();
+            exit(EXIT_SUCCESS);
+        case KEY_BACKSPACE: return Key::BACKSPACE;
+        case KEY_DC: return Key::DELETE;
+        case KEY_DOWN: return Key::ARROW_DOWN;
+        case KEY_END: return Key::END;
+        case KEY_ENTER: return Key::ENTER;
+        case KEY_F0 + 1: return Key::F1;
+        case KEY_F0 + 2: return Key::F2;
+        case KEY_F0 + 3: return Key::F3;
+        case KEY_F0 + 4: return Key::F4;
+        case KEY_F0 + 5: return Key::F5;
+        case KEY_F0 + 6: return Key::F6;
+        case KEY_F0 + 7: return Key::F7;
+        case KEY_F0 + 8: return Key::F8;
+        case KEY_F0 + 9: return Key::F9;
+        case KEY_F0 + 10: return Key::F10;
+        case KEY_F0 + 11: return Key::F11;
+        case KEY_F0 + 12: return Key::F12;
+        case KEY_HOME: return Key::HOME;
+        case KEY_IC: return Key::INSERT;
+        case KEY_LEFT: return Key::ARROW_LEFT;
+        case KEY_NPAGE: return Key::PAGE_DOWN;
+        case KEY_PPAGE: return Key::PAGE_UP;
+        case KEY_RIGHT: return Key::ARROW_RIGHT;
+        case KEY_UP: return Key::ARROW_UP;
+        case 0xA3: return Key::POUND;
+        case 0xAC: return Key::NOT;
+#ifdef INVICTUS_TARGET_WINDOWS
+        case KEY_A1: return Key::KP7;
+        case KEY_A2: return Key::KP8;
+        case KEY_A3: return Key::KP9;
+        case KEY_B1: return Key::KP4;
+        case KEY_B2: return Key::KP5;
+        case KEY_B3: return Key::KP6;
+        case KEY_C1: return Key::KP1;
+        case KEY_C2: return Key::KP2;
+        case KEY_C3: return Key::KP3;
+        case PAD0: return Key::KP0;
+        case PADENTER: return Key::ENTER;
+        case PADSTOP: return '.';
+        case PADMINUS: return '-';
+        case PADPLUS: return '+';
+        case PADSLASH: return '/';
+        case PADSTAR: return '*';
+#endif
+        default: return Key::UNKNOWN_KEY;
+    }
+}
+
 // Turns the cursor on or off.
 void Terminal::set_cursor(bool enabled)
 {
+    if (headless_ || ansi_) return;
     if (enabled)
     {
         cursor_state_ = 2;
@@ -512,4 +643,7 @@ void Terminal::set_cursor(bool enabled)
     }
 }
 
+// Sets a source of simulated keypresses, to be used instead of the keyboard.
+void Terminal::set_key_source(std::function<int()> source) { key_source_ = source; }
+
 }   // namespace invictus
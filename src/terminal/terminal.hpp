@@ -5,9 +5,11 @@
 #define TERMINAL_TERMINAL_HPP_
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "terminal/terminal-shared-defs.hpp"
 
@@ -15,24 +17,28 @@
 namespace invictus
 {
 
-class Window;   // defined in terminal/window.hpp
+class StyledText;   // defined in terminal/styled-text.hpp
+class Window;       // defined in terminal/window.hpp
 
 
 class Terminal
 {
 public:
-                Terminal();     // Sets up the Curses terminal.
+                Terminal(bool headless = false);    // Sets up the Curses terminal, or a null terminal which draws nothing, for headless mode.
                 ~Terminal();    // Destructor, calls cleanup code.
+    static bool ansi();         // Checks if the terminal is using the ANSI backend, which writes escape sequences directly instead of using Curses.
     void        box(std::shared_ptr<Window> window = nullptr, Colour colour = Colour::NONE, unsigned int flags = 0);    // Draws a box around a Window.
     static void cleanup();      // Cleans up Curses, resets the terminal to its former state.
     void        clear_line(std::shared_ptr<Window> window = nullptr);   // Clears the current line.
     void        cls(std::shared_ptr<Window> window = nullptr);          // Clears the screen.
     void        flip();     // Updates the screen.
     void        flush();    // Flushes the input buffer.
+    void        flush_cells(std::shared_ptr<Window> window);    // Sends any cells in a Window's framebuffer which have changed since the last flush to Curses.
     uint16_t    get_cols(std::shared_ptr<Window> window = nullptr); // Gets the number of columns available on the screen right now.
     uint16_t    get_cursor_x(std::shared_ptr<Window> window = nullptr); // Gets the current cursor X coordinate.
     uint16_t    get_cursor_y(std::shared_ptr<Window> window = nullptr); // Gets the current cursor Y coordinate.
     int         get_key(std::shared_ptr<Window> window = nullptr);      // Gets keyboard input from the user.
+    static bool headless();     // Checks if the terminal is running in headless mode, without Curses.
     uint16_t    get_midcol(std::shared_ptr<Window> window = nullptr);   // Gets the central column of the specified Window.
     uint16_t    get_midrow(std::shared_ptr<Window> window = nullptr);   // Gets the central row of the specified Window.
     uint16_t    get_rows(std::shared_ptr<Window> window = nullptr);     // Gets the number of rows available on the screen right now.
@@ -43,21 +49,41 @@ public:
                                                                                         // -1 for either coordinate retains its current position on that axis.
                 // Prints a string at a given coordinate on the screen.
     void        print(std::string str, int x, int y, Colour col = Colour::WHITE, unsigned int flags = 0, std::shared_ptr<Window> window = nullptr);
+                // As above, but prints text with its colour tags already parsed, optionally only printing part of it.
+    void        print(const StyledText &text, int x, int y, Colour col = Colour::WHITE, unsigned int flags = 0, std::shared_ptr<Window> window = nullptr,
+                    uint32_t start = 0, uint32_t length = UINT32_MAX);
                 // Prints a character at a given coordinate on the screen.
     void        put(uint32_t letter, int x, int y, Colour col = Colour::WHITE, unsigned int flags = 0, std::shared_ptr<Window> window = nullptr);
                 // As above, but a wrapper to allow use of the Glyph enum.
     void        put(Glyph letter, int x, int y, Colour col = Colour::WHITE, unsigned int flags = 0, std::shared_ptr<Window> window = nullptr);
     void        set_cursor(bool enabled);   // Turns the cursor on or off.
+    void        set_key_source(std::function<int()> source);    // Sets a source of simulated keypresses, to be used instead of the keyboard.
 
 private:
+    ScreenCell* ansi_cell(std::shared_ptr<Window> window, int x, int y);    // Returns a cell on the screen or in a Window, or nullptr if it's out of bounds.
+    static void ansi_cleanup(); // Restores the terminal to its former state, after the ANSI backend has been using it.
+    void        ansi_flip();    // Draws everything that's changed on the screen since the last update, with the ANSI backend.
+    bool        ansi_init();    // Sets up the terminal for the ANSI backend. Returns false if the backend can't be used.
+    int         ansi_read_key();    // Reads a keypress directly from the terminal, and converts it into a key code.
+    void        ansi_resize();  // Checks the terminal's size, and resizes the screen buffers to match.
+    std::string ansi_sgr(Colour col, unsigned int flags, bool unprintable); // Returns the escape sequence to set the colour and attributes of a cell.
     unsigned long   colour_pair_code(Colour col, uint32_t flags = 0);   // Returns a colour pair code.
+    unsigned long   glyph_code(uint32_t letter, Colour col, unsigned int flags, uint8_t acs_flags); // Converts a character into a Curses code.
+    int         read_key(std::shared_ptr<Window> window);   // Reads a keypress from Curses, and converts it into a key code.
 
+    static bool ansi_;              // Is the terminal using the ANSI backend, rather than Curses?
+    uint16_t    ansi_cols_, ansi_rows_; // The size of the screen, with the ANSI backend.
+    std::vector<ScreenCell> ansi_frame_;    // Scratch memory, where the screen and every visible Window are combined into a single frame.
+    std::vector<ScreenCell> ansi_screen_;   // Everything drawn directly onto the screen, rather than into a Window.
+    std::vector<ScreenCell> ansi_sent_;     // What the terminal is currently showing, so only the cells which have changed need to be sent.
     static bool cleanup_done_;      // Has the cleanup routine already run once?
     int         cursor_state_;      // The current state of the cursor.
     std::string escape_key_string_; // The last escape key string processed.
     bool        has_colour_;        // The terminal has colour support.
+    static bool headless_;          // Is the terminal running in headless mode, with no Curses at all?
     bool        initialized_;       // Has Curses been initialized?
     int         key_raw_;           // The raw, unprocessed input from wgetch().
+    std::function<int()>    key_source_;    // Where simulated keypresses come from, if the keyboard isn't being used.
 
     static std::map<std::string, int>   escape_code_index_; // Hard-coded list of escape codes used by various terminals.
 };
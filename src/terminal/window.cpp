@@ -1,6 +1,8 @@
 // terminal/window.cpp -- The Window class, part of the Terminal subsystem, allowing easier management of Curses windows and panels.
 // Copyright © 2019, 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
 
+#include <algorithm>
+
 #include <curses.h>
 #include <panel.h>
 
@@ -13,6 +15,9 @@
 namespace invictus
 {
 
+std::vector<Window*>    Window::stack_; // With the ANSI backend, every Window in the order they're stacked on the screen, from the bottom up.
+
+
 Window::Window(int width, int height, int new_x, int new_y)
 {
     if (width < 1) width = 1;
@@ -24,16 +29,46 @@ Window::Window(int width, int height, int new_x, int new_y)
     width_ = width;
     x_ = new_x;
     y_ = new_y;
+    visible_ = true;
+    if (Terminal::headless() || Terminal::ansi())
+    {
+        // There's no Curses in headless mode, so the Window just keeps track of its own size.
+        panel_ptr_ = nullptr;
+        window_ptr_ = nullptr;
+
+        // The ANSI backend needs somewhere to keep the Window's contents instead, and puts new Windows on top of the others, as Curses would.
+        if (Terminal::ansi())
+        {
+            front_.resize(width_ * height_, {' ', Colour::NONE, 0});
+            stack_.push_back(this);
+        }
+        return;
+    }
     window_ptr_ = newwin(height, width, new_y, new_x);
     panel_ptr_ = new_panel(window_ptr_);
 }
 
 Window::~Window()
 {
+    stack_.erase(std::remove(stack_.begin(), stack_.end(), this), stack_.end());
+    if (!window_ptr_) return;
     del_panel(panel_ptr_);
     delwin(window_ptr_);
 }
 
+// Clears this Window's framebuffer, ready for a new frame to be drawn into it.
+void Window::clear_cells()
+{
+    const ScreenCell blank = {' ', Colour::NONE, 0};
+    if (back_.empty())
+    {
+        // The framebuffer is only created when it's first used, as most Windows are drawn directly. A new Curses window starts out blank, and so does this.
+        back_.resize(width_ * height_, blank);
+        if (front_.empty()) front_.resize(width_ * height_, blank);
+    }
+    else std::fill(back_.begin(), back_.end(), blank);
+}
+
 // Read-only access to the Window's height.
 uint16_t Window::get_height() const { return height_; }
 
@@ -45,12 +80,27 @@ void Window::move(int new_x, int new_y)
 {
     x_ = new_x;
     y_ = new_y;
-    move_panel(panel_ptr_, y_, x_);
+    if (panel_ptr_) move_panel(panel_ptr_, y_, x_);
+}
+
+// Draws a character into this Window's framebuffer, to be sent to Curses by Terminal::flush_cells().
+void Window::set_cell(uint32_t letter, int x, int y, Colour col, unsigned int flags)
+{
+    if (x < 0 || y < 0 || x >= width_ || y >= height_ || back_.empty()) return;
+    back_[x + (y * width_)] = {letter, col, static_cast<uint8_t>(flags)};
 }
 
 // Set this Window's panel as visible or invisible.
 void Window::set_visible(bool vis)
 {
+    visible_ = vis;
+    if (vis && Terminal::ansi())
+    {
+        // As with Curses panels, showing a Window brings it to the top.
+        stack_.erase(std::remove(stack_.begin(), stack_.end(), this), stack_.end());
+        stack_.push_back(this);
+    }
+    if (!panel_ptr_) return;
     if (vis) show_panel(panel_ptr_);
     else hide_panel(panel_ptr_);
 }
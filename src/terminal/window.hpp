@@ -4,6 +4,8 @@
 #ifndef TERMINAL_WINDOW_HPP_
 #define TERMINAL_WINDOW_HPP_
 
+#include <vector>
+
 #include "terminal/terminal-shared-defs.hpp"
 
 
@@ -15,18 +17,29 @@ class Window
 public:
                 Window(int width, int height, int new_x = 0, int new_y = 0);
                 ~Window();
+    void        clear_cells();      // Clears this Window's framebuffer, ready for a new frame to be drawn into it.
     uint16_t    get_height() const; // Read-only access to the Window's height.
     uint16_t    get_width() const;  // Read-only access to the Window's width.
     void        move(int new_x, int new_y); // Moves this Window's underlying panel to new coordinates.
+                // Draws a character into this Window's framebuffer, to be sent to Curses by Terminal::flush_cells().
+    void        set_cell(uint32_t letter, int x, int y, Colour col = Colour::WHITE, unsigned int flags = 0);
     void        set_visible(bool vis);      // Set this Window's panel as visible or invisible.
     WINDOW*     win() const;    // Returns a pointer to the WINDOW struct.
 
 private:
+    static std::vector<Window*> stack_; // With the ANSI backend, every Window in the order they're stacked on the screen, from the bottom up.
+
+    std::vector<ScreenCell> back_;  // The frame currently being drawn, which is sent to Curses by Terminal::flush_cells().
+    std::vector<ScreenCell> front_; // The frame that was last sent to Curses, so only the cells which have changed need to be drawn again. With the ANSI
+                                    // backend there's no Curses window, so this always holds everything drawn in this Window.
     uint16_t    height_;        // The height of this Window.
     PANEL*      panel_ptr_;     // A pointer to the underlying PANEL struct.
+    bool        visible_;       // Is this Window currently visible? (Only used by the ANSI backend; Curses keeps track of this itself.)
     uint16_t    width_;         // The width of this Window.
     WINDOW*     window_ptr_;    // A pointer to the underlying WINDOW struct.
     int         x_, y_;         // The screen coordinates of this Window.
+
+friend class Terminal;
 };
 
 }       // namespace invictus
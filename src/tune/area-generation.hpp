@@ -8,6 +8,7 @@ namespace invictus
 {
 
 constexpr bool  AREA_GEN_DEBUG_MESSAGES = false;    // Enable debug dungeon generation messages in the Guru log.
+constexpr int   DUNGEON_LEVELS =                5;  // The number of levels in the dungeon. The Crown of Kings lies on the lowest one.
 constexpr int   DUNGEON_MAX_WALKABLE =          50; // The maximum % of the map that needs to be walkable (i.e. floor) to be considered viable.
                                                     // Too much of this can be bad, as it leads to cluttered maps.
 constexpr int   DUNGEON_MIN_WALKABLE =          20; // The minimum % of the map that needs to be walkable (i.e. floor) to be considered viable.
@@ -0,0 +1,16 @@
+// tune/headless.hpp -- Values used by the headless simulation mode, which runs the game without Curses for soak tests and benchmarks.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef TUNE_HEADLESS_HPP_
+#define TUNE_HEADLESS_HPP_
+
+namespace invictus
+{
+
+constexpr int   HEADLESS_DEFAULT_TURNS =    10000;  // How many turns the headless bot plays, if not specified on the command line.
+constexpr int   HEADLESS_SCREEN_COLS =      120;    // The width of the imaginary screen the headless terminal pretends to have.
+constexpr int   HEADLESS_SCREEN_ROWS =      40;     // The height of the imaginary screen the headless terminal pretends to have.
+constexpr int   HEADLESS_STUCK_TURNS =      50;     // If the bot fails to make progress for this many turns, it wanders randomly for a while.
+
+}       // namespace invictus
+#endif  // TUNE_HEADLESS_HPP_
@@ -0,0 +1,14 @@
+// tune/terminal.hpp -- Values which adjust how the Terminal talks to the screen and keyboard.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef TUNE_TERMINAL_HPP_
+#define TUNE_TERMINAL_HPP_
+
+namespace invictus
+{
+
+constexpr int   ANSI_ESCAPE_TIMEOUT =   25; // How long the ANSI backend waits for the rest of an escape sequence, in milliseconds, before deciding it was just
+                                            // the escape key being pressed.
+
+}       // namespace invictus
+#endif  // TUNE_TERMINAL_HPP_
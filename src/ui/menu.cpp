@@ -7,7 +7,6 @@
 #include "terminal/window.hpp"
 #include "ui/menu.hpp"
 #include "ui/ui.hpp"
-#include "util/strx.hpp"
 
 
 namespace invictus
@@ -23,7 +22,7 @@ Menu::~Menu() { if (core() && core()->game() && core()->game()->ui()) core()->ga
 // Adds an item to this Menu.
 void Menu::add_item(const std::string &txt, int ch, Colour col , bool arrow)
 {
-    if (txt.size()) items_.push_back(txt); else items_.push_back("");
+    items_.push_back(StyledText(txt));
     item_chars_.push_back(ch);
     item_x_.push_back(0);
     colour_.push_back(col);
@@ -62,8 +61,10 @@ int Menu::render()
         {
             terminal->cls(window_);
             terminal->box(window_, Colour::WHITE);
-            terminal->print(" " + title_ + "{w} ", (window_->get_width() / 2) - (StrX::strlen_colour(title_) / 2) - 1, 0, Colour::WHITE, PRINT_FLAG_REVERSE,
-                window_);
+            const int title_x = (window_->get_width() / 2) - (title_.length() / 2) - 1;
+            terminal->put(' ', title_x, 0, Colour::WHITE, PRINT_FLAG_REVERSE, window_);
+            terminal->print(title_, title_x + 1, 0, Colour::WHITE, PRINT_FLAG_REVERSE, window_);
+            terminal->put(' ', title_x + 1 + title_.length(), 0, Colour::WHITE, PRINT_FLAG_REVERSE, window_);
             const unsigned int start = offset_;
             unsigned int end = items_.size();
             if (end - offset_ > 20) end = 20 + offset_;
@@ -71,8 +72,8 @@ int Menu::render()
             {
                 const bool inverse = (selected_ == i && allow_highlight_);
                 const bool item_char = (item_chars_.at(i) != '\0');
-                terminal->print((item_char ? " " : "") + items_.at(i), item_x_.at(i) - (item_char ? 1 : 0), 2 + i - offset_, Colour::WHITE, inverse ?
-                    PRINT_FLAG_REVERSE : 0, window_);
+                if (item_char) terminal->put(' ', item_x_.at(i) - 1, 2 + i - offset_, Colour::WHITE, inverse ? PRINT_FLAG_REVERSE : 0, window_);
+                terminal->print(items_.at(i), item_x_.at(i), 2 + i - offset_, Colour::WHITE, inverse ? PRINT_FLAG_REVERSE : 0, window_);
                 if (item_chars_.at(i) != '\0')
                     terminal->put(item_chars_.at(i), item_x_.at(i) - 2, 2 + i - offset_, colour_.at(i), inverse ? PRINT_FLAG_REVERSE : 0, window_);
             }
@@ -91,13 +92,13 @@ int Menu::render()
         else if (game->is_key_north(key) && selected_ > 0)
         {
             selected_--;
-            while (selected_ > 0 && (!items_.at(selected_).size() || colour_.at(selected_) == Colour::BLACK_BOLD)) selected_--;
+            while (selected_ > 0 && (items_.at(selected_).empty() || colour_.at(selected_) == Colour::BLACK_BOLD)) selected_--;
             redraw = true;
         }
         else if (game->is_key_south(key) && selected_ < items_.size() - 1)
         {
             selected_++;
-            while (selected_ < items_.size() - 1 && (!items_.at(selected_).size() || colour_.at(selected_) == Colour::BLACK_BOLD)) selected_++;
+            while (selected_ < items_.size() - 1 && (items_.at(selected_).empty() || colour_.at(selected_) == Colour::BLACK_BOLD)) selected_++;
             if (selected_ > 0 && colour_.at(selected_) == Colour::BLACK_BOLD)
                 while (selected_ > 0 && colour_.at(selected_) == Colour::BLACK_BOLD) selected_--;
             redraw = true;
@@ -122,9 +123,8 @@ void Menu::reposition()
     bool add_arrows = false;
     for (unsigned int i = 0; i < items_.size(); i++)
     {
-        std::string item = items_.at(i);
-        unsigned int len = StrX::strlen_colour(item);
-        if (arrows_.at(i) && items_.at(i).at(items_.at(i).size() - 1) != '>') add_arrows = true;
+        const unsigned int len = items_.at(i).length();
+        if (arrows_.at(i) && !items_.at(i).empty() && items_.at(i).text().back() != '>') add_arrows = true;
         if (len > widest) widest = len;
     }
 
@@ -133,14 +133,13 @@ void Menu::reposition()
     {
         for (unsigned int i = 0; i < items_.size(); i++)
         {
-            if (!items_.at(i).size()) continue;
-            int target_len = widest;
-            items_.at(i) = StrX::pad_string(items_.at(i), target_len, true);
-            if (arrows_.at(i)) items_.at(i) += " {W}>";
+            if (items_.at(i).empty()) continue;
+            if (items_.at(i).length() < widest) items_.at(i).append(std::string(widest - items_.at(i).length(), ' '));
+            if (arrows_.at(i)) items_.at(i).append(" {W}>");
         }
     }
 
-    if (title_.size() > widest) widest = title_.size();
+    if (title_.length() > widest) widest = title_.length();
     size_x_ = widest + 4 + (has_item_chars_ ? 2 : 0) + (add_arrows ? 2 : 0);
     size_y_ = items_.size() + 4;
     if (size_y_ > 24) size_y_ = 24;
@@ -162,9 +161,9 @@ void Menu::reposition()
     for (unsigned int i = 0; i < item_x_.size(); i++)
     {
         if (left_aligned_) item_x_.at(i) = (item_chars_.at(i) == '\0' ? (has_item_chars_ ? 4 : 2) : 4);
-        else item_x_.at(i) = (size_x_ / 2) - (StrX::strlen_colour(items_.at(i)) / 2) + (item_chars_.at(i) == '\0' ? 0 : 1);
+        else item_x_.at(i) = (size_x_ / 2) - (items_.at(i).length() / 2) + (item_chars_.at(i) == '\0' ? 0 : 1);
     }
-    title_x_ = StrX::strlen_colour(title_) / 2;
+    title_x_ = title_.length() / 2;
 
     window_->move(pos_x_, pos_y_);
 }
@@ -184,6 +183,6 @@ void Menu::set_selected(unsigned int pos)
 }
 
 // Sets the Menu's title.
-void Menu::set_title(const std::string &str) { title_ = str; }
+void Menu::set_title(const std::string &str) { title_ = StyledText(str); }
 
 }   // namespace invictus
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 
+#include "terminal/styled-text.hpp"
 #include "terminal/terminal-shared-defs.hpp"
 
 
@@ -42,14 +43,14 @@ private:
     bool                        has_item_chars_;        // Do any of the menu items have a char set?
     std::vector<int>            item_chars_;            // Extra characters for menu items.
     std::vector<int>            item_x_;                // The menu item positions.
-    std::vector<std::string>    items_;                 // The menu item text.
+    std::vector<StyledText>     items_;                 // The menu item text, with the colour tags already parsed.
     bool                        left_aligned_;          // The menu should be left-aligned.
     unsigned int                offset_;                // The menu scroll.
     int                         pos_x_, pos_y_;         // Screen coordinates.
     bool                        return_after_render_;   // Whether to return the selected value *after* doing one more render pass.
     unsigned int                selected_;              // The selected menu item.
     int                         size_x_, size_y_;       // The size of the menu.
-    std::string                 title_;                 // The menu's title, if any.
+    StyledText                  title_;                 // The menu's title, if any.
     int                         title_x_;               // Title horizontal position.
     std::shared_ptr<Window>     window_;                // The Menu's rendering window.
 };
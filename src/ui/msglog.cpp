@@ -1,17 +1,19 @@
 // ui/msglog.cpp -- The message log, which displays important information to the player.
 // Copyright © 2020, 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
 
+#include <algorithm>
 #include <cstddef>
+#include <utility>
 
 #include "core/core.hpp"
 #include "core/game-manager.hpp"
+#include "entity/player.hpp"
 #include "terminal/terminal.hpp"
 #include "terminal/window.hpp"
 #include "tune/message-log.hpp"
 #include "ui/msglog.hpp"
 #include "ui/ui.hpp"
 #include "util/random.hpp"
-#include "util/strx.hpp"
 #include "util/timer.hpp"
 
 
@@ -19,28 +21,46 @@ namespace invictus
 {
 
 // Constructor, sets up the message log window.
-MessageLog::MessageLog() : buffer_pos_(0), timer_(std::make_shared<Timer>())
+MessageLog::MessageLog() : fade_before_(0), messages_(MESSAGE_LOG_OUTPUT_BUFFER_MAX), next_id_(0), scroll_(0), scrolling_(false),
+    timer_(std::make_shared<Timer>()) { }
+
+// Adds a message to the output buffer, recycling the oldest message if it's full.
+MessageLog::LogMessage& MessageLog::add(const std::string &msg)
 {
-    // Empty the log to begin with, so new messages show at the bottom.
-    output_raw_.resize(MESSAGE_LOG_HEIGHT - 2);
-    output_raw_fade_.resize(MESSAGE_LOG_HEIGHT - 2);
+    LogMessage &new_msg = messages_.push_back();
+    new_msg.id = next_id_++;
+    new_msg.text = StyledText(msg);
+    new_msg.wrap_width = 0;
+    return new_msg;
 }
 
 // Amends the last message, adding additional text.
 void MessageLog::amend(const std::string &str)
 {
-    if (!output_raw_.size())
+    if (messages_.empty())
     {
         message(str);
         return;
     }
-    output_raw_.at(output_raw_.size() - 1) += str;
-    process_output_buffer();
+    LogMessage &msg = messages_.back();
+    msg.text.append(str);
+    msg.wrap_width = 0;
+    scroll_ = 0;
 }
 
 // Prints a blank line.
 void MessageLog::blank_line() { message(" "); }
 
+// Counts the wrapped lines in the output buffer, from the newest message back, stopping at the limit.
+uint32_t MessageLog::count_lines(uint32_t limit)
+{
+    const uint16_t width = wrap_width();
+    uint32_t count = 0;
+    for (size_t i = messages_.size(); i > 0 && count < limit; i--)
+        count += wrapped(messages_.at(i - 1), width).size();
+    return std::min(count, limit);
+}
+
 // Gets user input from the message log window.
 std::string MessageLog::get_string()
 {
@@ -84,12 +104,15 @@ std::string MessageLog::get_string()
         else if (key == Key::ENTER) break;
     }
 
-    output_raw_.at(output_raw_.size() - 1) = "";
+    messages_.back().text = StyledText();
     amend("{g}> " + result);
     ui->redraw_message_log();
     return result;
 }
 
+// Checks if a message is old enough to be drawn faded.
+bool MessageLog::is_faded(const LogMessage &msg) const { return msg.id < fade_before_; }
+
 // Adds a message to the log!
 void MessageLog::message(std::string msg, unsigned char awaken_chance)
 {
@@ -97,8 +120,7 @@ void MessageLog::message(std::string msg, unsigned char awaken_chance)
     if (timer_->elapsed() >= MESSAGE_LOG_FADE_TIMER)
     {
         timer_->reset();
-        for (unsigned int i = 0; i < output_raw_fade_.size(); i++)
-            output_raw_fade_.at(i) = true;
+        fade_before_ = next_id_;
     }
 
     // Split the message if we detect a \n specified in there.
@@ -110,88 +132,121 @@ void MessageLog::message(std::string msg, unsigned char awaken_chance)
         return;
     }
 
-    // Check to see if this is something that will wake up the sleeping player.
-    const bool sleeping = false;    // todo: When player resting/sleeping is implemented, do a check for a sleeping player here.
+    // Check to see if this is something that will wake up the sleeping player. If it doesn't, they don't get to see the message.
+    auto player = core()->game()->player();
+    const bool sleeping = (player && !player->is_awake() && !player->is_dead());
+    bool wake_up = false;
     if (sleeping && awaken_chance > 0 && awaken_chance != AWAKEN_CHANCE_ALWAYS_SHOW_BUT_NEVER_WAKE)
     {
-        if (Random::rng(100) <= awaken_chance) { }  // todo: When player sleeping/resting is implemented, trigger a wake-up here.
+        if (Random::rng(100) <= awaken_chance) wake_up = true;
         else return;
     }
 
-    output_raw_.push_back(msg);
-    output_raw_fade_.push_back(false);
-    process_output_buffer();    // Reprocess the text, to make sure it's all where it should be.
+    add(msg);
+    scroll_ = 0;
     core()->game()->ui()->redraw_message_log(); // Tells the UI that the message log window should be redrawn.
+    if (wake_up) player->wake();
 }
 
-// Processes the output buffer after an update.
-void MessageLog::process_output_buffer()
+// Clears the entire output buffer.
+void MessageLog::purge_buffer()
 {
-    // Trim the output buffer if necessary.
-    while (output_raw_.size() > MESSAGE_LOG_OUTPUT_BUFFER_MAX)
-    {
-        output_raw_.erase(output_raw_.begin());
-        output_raw_fade_.erase(output_raw_fade_.begin());
-    }
+    messages_.clear();
+    fade_before_ = next_id_ = scroll_ = 0;
+    timer_->reset();
+}
 
-    // Clear the processed buffer.
-    output_prc_.clear();
-    output_prc_fade_.clear();
-    if (!output_raw_.size()) return;
+// Draws the message log on the screen.
+void MessageLog::render()
+{
+    auto terminal = core()->terminal();
+    auto msg_window = core()->game()->ui()->message_log_window();
+    terminal->box(msg_window, Colour::WHITE);
 
-    // Process the output buffer.
-    int term_width = core()->game()->ui()->message_log_window()->get_width();
-    for (unsigned int i = 0; i < output_raw_.size(); i++)
+    // Work backwards from the newest message, skipping any lines the view is scrolled past, until the window is full. Only the messages that end up on the
+    // screen need to be word-wrapped, so it doesn't matter how long the output buffer gets.
+    const uint32_t height = MESSAGE_LOG_HEIGHT - 2;
+    const uint16_t width = wrap_width();
+    std::pair<const LogMessage*, StyledText::Line> visible[MESSAGE_LOG_HEIGHT - 2];
+    uint32_t count = 0, skip = scroll_;
+    for (size_t i = messages_.size(); i > 0 && count < height; i--)
     {
-        std::vector<std::string> line_vec = StrX::string_explode_colour(output_raw_.at(i), term_width - 2);
-        for (auto line : line_vec)
+        LogMessage &msg = messages_.at(i - 1);
+        const auto &lines = wrapped(msg, width);
+        for (size_t j = lines.size(); j > 0 && count < height; j--)
         {
-            output_prc_.push_back(line);
-            output_prc_fade_.push_back(output_raw_fade_.at(i));
+            if (skip) skip--;
+            else visible[count++] = {&msg, lines.at(j - 1)};
         }
     }
 
-    // Reset the buffer position if needed.
-    reset_buffer_pos();
-}
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const auto &line = visible[count - i - 1];
+        terminal->print(line.first->text, 1, i + 1, Colour::WHITE, is_faded(*line.first) ? PRINT_FLAG_DARK : PRINT_FLAG_BOLD, msg_window, line.second.offset,
+            line.second.length);
+    }
 
-// Clears the entire output buffer.
-void MessageLog::purge_buffer()
-{
-    output_raw_.clear();
-    output_raw_fade_.clear();
-    output_prc_.clear();
-    output_prc_fade_.clear();
-    buffer_pos_ = 0;
-    timer_->reset();
+    if (scrolling_)
+    {
+        if (count_lines(scroll_ + height + 1) > scroll_ + height) terminal->put('^', 0, 1, Colour::WHITE, PRINT_FLAG_REVERSE, msg_window);
+        if (scroll_) terminal->put('v', 0, height, Colour::WHITE, PRINT_FLAG_REVERSE, msg_window);
+    }
 }
 
-// Resets the output buffer position.
-void MessageLog::reset_buffer_pos()
-{
-    buffer_pos_ = 0;
-    const unsigned int height = MESSAGE_LOG_HEIGHT - 2;
-    if (output_prc_.size() > height) buffer_pos_ = output_prc_.size() - height;
-}
+// Lets the message log know the screen size has changed. Each message remembers the width it was wrapped to, so they'll be wrapped again as they're drawn.
+void MessageLog::screen_resized() { scroll_ = 0; }
 
-// Draws the message log on the screen.
-void MessageLog::render()
+// Lets the player scroll back through older messages.
+void MessageLog::scrollback()
 {
-    auto terminal = core()->terminal();
-    auto ui = core()->game()->ui();
-    auto msg_window = ui->message_log_window();
-    terminal->box(msg_window, Colour::WHITE);
+    auto game = core()->game();
+    auto ui = game->ui();
+    const uint32_t height = MESSAGE_LOG_HEIGHT - 2;
 
-    if (output_prc_.size())
+    scrolling_ = true;
+    while (true)
     {
-        unsigned int end = output_prc_.size();
-        if (end - buffer_pos_ > MESSAGE_LOG_HEIGHT - 2) end = buffer_pos_ + MESSAGE_LOG_HEIGHT - 2;
-        for (unsigned int i = buffer_pos_; i < end; i++)
-            terminal->print(output_prc_.at(i), 1, i - buffer_pos_ + 1, Colour::WHITE, output_prc_fade_.at(i) ? PRINT_FLAG_DARK : PRINT_FLAG_BOLD, msg_window);
+        ui->redraw_message_log();
+        ui->render();
+
+        uint32_t magnitude = 0;
+        bool up = false;
+        const int key = game->get_key();
+        if (key == Key::RESIZE) continue;
+        else if (game->is_key_north(key) || key == Key::PAGE_UP) { magnitude = (key == Key::PAGE_UP ? height : 1); up = true; }
+        else if (game->is_key_south(key) || key == Key::PAGE_DOWN) magnitude = (key == Key::PAGE_DOWN ? height : 1);
+        else if (key == Key::HOME) { magnitude = MESSAGE_LOG_OUTPUT_BUFFER_MAX * height; up = true; }
+        else if (key == Key::END) magnitude = scroll_;
+        else if (key == ' ' || key == 'q' || key == 'Q' || key == Key::ESCAPE || key == Key::ENTER) break;
+
+        if (up)
+        {
+            // Only count as many lines as are needed to know how far back the view can go.
+            const uint32_t lines = count_lines(scroll_ + magnitude + height);
+            scroll_ = (lines > height ? std::min(scroll_ + magnitude, lines - height) : 0);
+        }
+        else scroll_ -= std::min(scroll_, magnitude);
     }
+
+    scrolling_ = false;
+    scroll_ = 0;
+    ui->redraw_message_log();
 }
 
-// Lets the message log know the screen size has changed.
-void MessageLog::screen_resized() { process_output_buffer(); }
+// Returns the width the messages should be word-wrapped to.
+uint16_t MessageLog::wrap_width() const { return core()->game()->ui()->message_log_window()->get_width() - 2; }
+
+// Word-wraps a message, if it's not already wrapped to this width.
+const std::vector<StyledText::Line>& MessageLog::wrapped(LogMessage &msg, uint16_t width)
+{
+    if (msg.wrap_width != width)
+    {
+        msg.lines.clear();
+        msg.text.wrap(width, msg.lines);
+        msg.wrap_width = width;
+    }
+    return msg.lines;
+}
 
 }   // namespace invictus
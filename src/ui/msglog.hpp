@@ -4,10 +4,14 @@
 #ifndef UI_MSGLOG_HPP_
 #define UI_MSGLOG_HPP_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "terminal/styled-text.hpp"
+#include "util/ring-buffer.hpp"
+
 
 namespace invictus
 {
@@ -25,18 +29,31 @@ public:
     void    message(std::string msg, unsigned char awaken_chance = 0);  // Adds a message to the output buffer.
     void    render();           // Draws the message log on the screen.
     void    screen_resized();   // Lets the message log know the screen size has changed.
+    void    scrollback();       // Lets the player scroll back through older messages.
 
 private:
-    void    process_output_buffer();    // Processes the output buffer after an update.
+    // A single message in the output buffer, along with its word-wrapped lines.
+    struct LogMessage
+    {
+        uint32_t    id = 0;         // The order this message was added in, used to tell if it has faded.
+        std::vector<StyledText::Line>   lines;  // The message, word-wrapped to fit the message log window. Only valid if wrap_width matches the window.
+        StyledText  text;           // The message itself, with its colour tags already parsed.
+        uint16_t    wrap_width = 0; // The width the lines were wrapped to, or 0 if they need wrapping again.
+    };
+
+    LogMessage& add(const std::string &msg);    // Adds a message to the output buffer, recycling the oldest message if it's full.
+    uint32_t    count_lines(uint32_t limit);    // Counts the wrapped lines in the output buffer, from the newest message back, stopping at the limit.
+    bool    is_faded(const LogMessage &msg) const;  // Checks if a message is old enough to be drawn faded.
     void    purge_buffer();     // Clears the entire output buffer.
-    void    reset_buffer_pos(); // Resets the output buffer position.
-
-    unsigned int                buffer_pos_;        // The position of the output buffer.
-    std::vector<std::string>    output_prc_;        // The nicely processed output buffer, ready for rendering.
-    std::vector<bool>           output_prc_fade_;   // The colour fade tags on older messages.
-    std::vector<std::string>    output_raw_;        // The raw, unprocessed output buffer.
-    std::vector<bool>           output_raw_fade_;   // The colour fade tags on older messages.
-    std::shared_ptr<Timer>      timer_;             // The timer for determining when old messages are stale.
+    uint16_t    wrap_width() const; // Returns the width the messages should be word-wrapped to.
+    const std::vector<StyledText::Line>&    wrapped(LogMessage &msg, uint16_t width);   // Word-wraps a message, if it's not already wrapped to this width.
+
+    uint32_t                fade_before_;   // Messages with an ID lower than this have faded.
+    RingBuffer<LogMessage>  messages_;      // The output buffer, holding the most recent messages.
+    uint32_t                next_id_;       // The ID to give the next message added.
+    uint32_t                scroll_;        // How many lines the view is scrolled back from the newest message.
+    bool                    scrolling_;     // Is the player currently scrolling back through the message log?
+    std::shared_ptr<Timer>  timer_;         // The timer for determining when old messages are stale.
 
 friend class SaveLoad;
 };
@@ -10,7 +10,9 @@
 #include "core/core.hpp"
 #include "core/game-manager.hpp"
 #include "entity/item.hpp"
+#include "entity/monster.hpp"
 #include "entity/player.hpp"
+#include "terminal/styled-text.hpp"
 #include "terminal/terminal.hpp"
 #include "terminal/window.hpp"
 #include "tune/ascii-symbols.hpp"
@@ -37,55 +39,49 @@ void Nearby::render()
     terminal->put(Glyph::RTEE, 0, window_h - MESSAGE_LOG_HEIGHT, Colour::WHITE, 0, nearby_window);
     terminal->put(Glyph::BTEE, 0, window_h - 1, Colour::WHITE, 0, nearby_window);
 
-    std::vector<std::string> nearby_lines;
+    std::vector<StyledText::Line> name_lines;   // Scratch space for word-wrapping names, reused for each one.
     bool item_stack_listed = false;
-    std::vector<std::shared_ptr<Entity>> mobiles, items;
+    std::vector<const Monster*> mobiles;
+    std::vector<const Entity*> items;
+    auto stack = std::make_shared<Item>();  // A stand-in Item to list for any stacks of items.
+    stack->set_name("multiple items");
+    stack->set_ascii(ASCII_STACK);
+    stack->set_colour(Colour::MAGENTA);
+
+    auto dungeon_view = ui->dungeon_view();
+    const int x1 = area->offset_x(), y1 = area->offset_y(), x2 = x1 + dungeon_view->get_width(), y2 = y1 + dungeon_view->get_height();
+
+    // Checks if an Entity is on the screen and visible, and not underfoot.
+    auto nearby = [&player, x1, y1, x2, y2](const Entity *entity) -> bool {
+        if (entity->x() < x1 || entity->y() < y1 || entity->x() >= x2 || entity->y() >= y2) return false;
+        return (entity->is_in_fov() && !entity->is_at(player->x(), player->y()));
+    };
 
-    for (auto entity : *area->entities())
-    {
-        if (!entity->is_in_fov() || entity->is_at(player->x(), player->y())) continue;
-        auto entity_type = entity->type();
-        if (entity_type != EntityType::ITEM && entity_type != EntityType::MONSTER) continue;
-        bool is_item = false;
-        if (entity_type == EntityType::MONSTER && std::dynamic_pointer_cast<Mobile>(entity)->is_dead()) is_item = true;
-        else if (entity_type == EntityType::ITEM) is_item = true;
-        if (is_item)
+    // Adds an item (or corpse) to the list, unless an item with the same name is already listed.
+    auto list_item = [&area, &items, &item_stack_listed, &stack](const Entity *entity) {
+        if (area->is_item_stack(entity->x(), entity->y()))
         {
-            bool already_on_list = false;
-            bool is_stack = area->is_item_stack(entity->x(), entity->y());
-            for (auto item : items)
-            {
-                if (item->name() == entity->name() && !is_stack)
-                {
-                    already_on_list = true;
-                    break;
-                }
-            }
-            if (!already_on_list)
-            {
-                if (is_stack)
-                {
-                    if (!item_stack_listed)
-                    {
-                        item_stack_listed = true;
-                        auto stack = std::make_shared<Item>();
-                        stack->set_name("multiple items");
-                        stack->set_ascii(ASCII_STACK);
-                        stack->set_colour(Colour::MAGENTA);
-                        items.push_back(stack);
-                    }
-                }
-                else items.push_back(entity);
-            }
+            if (item_stack_listed) return;
+            item_stack_listed = true;
+            items.push_back(stack.get());
+            return;
         }
-        else mobiles.push_back(entity);
-    }
+        for (auto item : items)
+            if (item->name() == entity->name()) return;
+        items.push_back(entity);
+    };
 
-    auto sort_entities = [](const std::shared_ptr<Entity> &lhs, const std::shared_ptr<Entity> &rhs) -> bool
+    for (auto &monster : area->monsters())
     {
-        return lhs->distance_from(core()->game()->player()) < rhs->distance_from(core()->game()->player());
-    };
+        if (!nearby(monster.get())) continue;
+        if (monster->is_dead()) list_item(monster.get());
+        else mobiles.push_back(monster.get());
+    }
+    for (auto &item : area->items())
+        if (nearby(item.get())) list_item(item.get());
 
+    const int px = player->x(), py = player->y();
+    auto sort_entities = [px, py](const Entity *lhs, const Entity *rhs) -> bool { return lhs->distance_from(px, py) < rhs->distance_from(px, py); };
     if (mobiles.size()) std::sort(mobiles.begin(), mobiles.end(), sort_entities);
     if (items.size()) std::sort(items.begin(), items.end(), sort_entities);
 
@@ -99,12 +95,11 @@ void Nearby::render()
         {
             terminal->put(mob->ascii(), 2, current_y, mob->colour(), 0, nearby_window);
 
-            auto mob_ptr = std::dynamic_pointer_cast<Mobile>(mob);
             std::string mob_name = mob->name();
             if (static_cast<int>(mob_name.size()) > window_w - 6) mob_name = mob_name.substr(0, window_w - 6);
             Colour bar_col = Colour::RED_WHITE;
-            if (!mob_ptr->is_awake()) bar_col = Colour::BLUE_WHITE;
-            Bars::render_bar(4, current_y, window_w - 6, mob_name, mob_ptr->hp(), mob_ptr->hp(true), bar_col, BAR_FLAG_ROUND_UP, nearby_window);
+            if (!mob->is_awake()) bar_col = Colour::BLUE_WHITE;
+            Bars::render_bar(4, current_y, window_w - 6, mob_name, mob->hp(), mob->hp(true), bar_col, BAR_FLAG_ROUND_UP, nearby_window);
             if (++current_y >= window_h - 1) return;
         }
     }
@@ -124,11 +119,13 @@ void Nearby::render()
         for (auto item : items)
         {
             terminal->put(item->ascii(), 2, current_y, item->colour(), 0, nearby_window);
-            std::vector<std::string> name_str = StrX::string_explode_colour("{w}" + item->name(), 16);
-            for (auto l : name_str)
+            const StyledText name("{w}" + item->name());
+            name_lines.clear();
+            name.wrap(16, name_lines);
+            for (auto &line : name_lines)
             {
                 if (current_y >= window_h - 1) return;
-                terminal->print(l, 4, current_y, Colour::WHITE, 0, nearby_window);
+                terminal->print(name, 4, current_y, Colour::WHITE, 0, nearby_window, line.offset, line.length);
                 current_y++;
             }
         }
@@ -141,29 +138,16 @@ void Nearby::render()
     current_y++;
 
     std::vector<Tile*> tiles;
-    int visible_x = ui->dungeon_view()->get_width(), visible_y = ui->dungeon_view()->get_height();
-    for (int x = 0; x < area->width(); x++)
+    // Only the tiles inside the dungeon view can be listed, so there's no need to look at the rest of the map.
+    const int x_start = std::max(0, area->offset_x()), x_end = std::min<int>(area->width(), area->offset_x() + dungeon_view->get_width());
+    const int y_start = std::max(0, area->offset_y()), y_end = std::min<int>(area->height(), area->offset_y() + dungeon_view->get_height());
+    for (int x = x_start; x < x_end; x++)
     {
-        int ox = x - area->offset_x();
-        if (ox < 0 || ox >= visible_x) continue;
-        for (int y = 0; y < area->height(); y++)
+        for (int y = y_start; y < y_end; y++)
         {
             if (x == player->x() && y == player->y()) continue;
-            int oy = y - area->offset_y();
-            if (oy < 0 || oy >= visible_y) continue;
-
             Tile* tile = area->tile(x, y);
-            bool is_visible = area->is_in_fov(x, y);
-
-            for (auto entity : *area->entities())
-            {
-                if (entity->x() == x && entity->y() == y)
-                {
-                    is_visible = false;
-                    break;
-                }
-            }
-            if (!is_visible) continue;
+            if (!area->is_in_fov(x, y) || area->entities_at(x, y).size()) continue;
 
             bool found = false;
             for (auto tc : tiles)
@@ -210,10 +194,12 @@ void Nearby::render()
         if (current_y >= window_h - 1) return;
         terminal->put(tile->ascii(), 2, current_y, tile->colour(), 0, nearby_window);
         
-        std::vector<std::string> name_str = StrX::string_explode_colour("{w}" + tile->name(), 16);
-        for (auto l : name_str)
+        const StyledText name("{w}" + tile->name());
+        name_lines.clear();
+        name.wrap(16, name_lines);
+        for (auto &line : name_lines)
         {
-            terminal->print(l, 4, current_y, Colour::WHITE, 0, nearby_window);
+            terminal->print(name, 4, current_y, Colour::WHITE, 0, nearby_window, line.offset, line.length);
             current_y++;
         }
     }
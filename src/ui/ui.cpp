@@ -132,8 +132,9 @@ void UI::render(ForceFlipMode mode)
     bool flip = (mode == ForceFlipMode::FORCE_FLIP);
     if (dungeon_needs_redraw_)
     {
-        core()->terminal()->cls(dungeon_view_);
+        dungeon_view_->clear_cells();
         core()->game()->area()->render();
+        core()->terminal()->flush_cells(dungeon_view_);
         dungeon_needs_redraw_ = false;
         flip = true;
     }
@@ -54,6 +54,7 @@ std::map<std::string, std::vector<std::string>> Wiki::wiki_data_ = {
         "{0}{C}g {w}- pick up items on the ground.",
         "{0}{C}i {w}- check your carried items.",
         "{0}{C}o {w}- open a nearby door.",
+        "{0}{C}Shift-M {w}- scroll back through older messages in the message log.",
         "{0}{C}Shift-R {w}- rest for a while, causing a longer period of [time] to pass.",
         "{C}Shift-S {w}- save the game.",
         } },
@@ -66,8 +67,19 @@ std::map<std::string, std::vector<std::string>> Wiki::wiki_data_ = {
         "{C}-acs-display {w}- Renders the Curses ACS glyphs, including the line-drawing characters and others. These may or may not be supported on your "
         "system, and are grouped into sets which can be disabled entirely via special flags in [prefs.txt].",
 
+        "{C}-fov-benchmark {w}- Generates a number of dungeon maps, and compares the speed and accuracy of the field-of-view code against the older "
+        "implementation it replaced. This is mostly of interest to developers.",
+
+        "{C}-headless {w}- Runs the game without Curses, with a simple bot playing through the dungeon for 10,000 turns (or a different number with "
+        "{C}-headless=<turns>{w}), then prints how fast the game ran, and how long was spent in each part of the game loop. The bot uses its own save "
+        "folder, so this won't touch your saved game. This is mostly of interest to developers.",
+
         "{C}-keycode-check {w}- Displays either the keycodes or escape sequences returned from Curses for any keys that are pressed. This can be useful for "
-        "debugging or adding escape codes from a terminal not yet supported by the game."
+        "debugging or adding escape codes from a terminal not yet supported by the game.",
+
+        "{C}-replay <file> {w}- Every new game is recorded to [userdata/replay.dat], which stores the game's random seed and every key pressed. This "
+        "option plays a recording back as fast as possible without Curses (or on-screen, if {C}-render {w}is also given), then checks that the game "
+        "ended up in exactly the same state, and prints timings in the same way as {C}-headless{w}. This is mostly of interest to developers."
     } },
 
     { "DUNGEON_VIEW",
@@ -204,6 +216,9 @@ std::map<std::string, std::vector<std::string>> Wiki::wiki_data_ = {
 #endif
         " - Which Curses ACS glyphs to use (see [Debug_Options]). Unused glyphs are replaced with the closest similar ASCII symbols.",
 
+        "{C}area_cache_size {w}(default: 4) - How many recently-visited dungeon levels to keep in memory, so that returning to them doesn't require "
+        "loading them from disk. Set to 0 to always load levels from disk.",
+
         "{C}pathfind_euclidean {w}(default: true) - If set to true, pathfinding will use the Euclidean method, which is more computationally expensive but "
         "more accurate. If set to false, it will use the faster, less-accurate Manhattan method.",
 
@@ -252,8 +267,8 @@ std::vector<bool> Wiki::link_good_;                     // Is this a valid link?
 unsigned int Wiki::link_selected_ = 0;                  // The current active wiki link.
 std::vector<std::string> Wiki::link_str_;               // Strings for the links.
 std::vector<std::string> Wiki::wiki_history_;           // Previous wiki pages viewed.
-std::vector<std::string> Wiki::wiki_prc_;               // The nicely processed wiki buffer, ready for rendering.
-std::vector<std::string> Wiki::wiki_raw_;               // The raw, unprocessed wiki buffer.
+std::vector<Wiki::WikiLine> Wiki::wiki_prc_;            // The nicely processed wiki buffer, word-wrapped and ready for rendering.
+std::vector<StyledText> Wiki::wiki_raw_;                // The raw wiki buffer, with each line's colour tags already parsed.
 std::shared_ptr<Window>  Wiki::wiki_window_ = nullptr;  // The wiki's render window.
 
 // (re)creates the wiki render window.
@@ -276,6 +291,9 @@ std::vector<std::string> Wiki::get_page(const std::string &page_name)
     return result->second;
 }
 
+// Checks if a line in the raw wiki buffer should be centred.
+bool Wiki::is_centred(const StyledText &raw) { return !raw.tagged().compare(0, 3, "{e}"); }
+
 // Processes input in the wiki window.
 void Wiki::process_key(int key)
 {
@@ -354,14 +372,14 @@ void Wiki::process_wiki_buffer()
     wiki_prc_.clear();
     if (!wiki_raw_.size()) return;
 
-    // Process the console buffer.
-    for (auto raw : wiki_raw_)
+    // Process the console buffer. Each line's colour tags were parsed when it was added, so this only needs to work out where the lines wrap.
+    std::vector<StyledText::Line> lines;
+    for (unsigned int i = 0; i < wiki_raw_.size(); i++)
     {
-        std::vector<std::string> line_vec = StrX::string_explode_colour(raw, wiki_window_->get_width() - 2);
-        for (auto prc : line_vec)
-        {
-            wiki_prc_.push_back(prc);
-        }
+        lines.clear();
+        wiki_raw_.at(i).wrap(wiki_window_->get_width() - 2, lines);
+        for (auto &line : lines)
+            wiki_prc_.push_back({i, line});
     }
 
     // Process the wiki links.
@@ -371,26 +389,24 @@ void Wiki::process_wiki_buffer()
     link_selected_ = 0;
     for (unsigned int i = 0; i < wiki_prc_.size(); i++)
     {
-        size_t start_pos = 0;
+        // The colour tags are already gone from the plain text, so link positions can be found directly.
+        const std::string &text = wiki_raw_.at(wiki_prc_.at(i).raw).text();
+        const size_t line_start = wiki_prc_.at(i).line.offset, line_end = line_start + wiki_prc_.at(i).line.length;
+        size_t start_pos = line_start;
         while(true)
         {
             // Locate opening wiki tags.
-            const size_t pos = wiki_prc_.at(i).find("[", start_pos++);
-            if (pos == std::string::npos) break;
-
-            // See if there's any ANSI or glyphs affecting the line length.
-            const unsigned int ansi_len = StrX::strlen_colour(wiki_prc_.at(i).substr(0, pos));
-            const unsigned int len = wiki_prc_.at(i).substr(0, pos).size();
-            const int diff = len - ansi_len;
+            const size_t pos = text.find("[", start_pos);
+            if (pos == std::string::npos || pos >= line_end) break;
 
             // Ensure the link is good, record it in the vectors if so.
-            const std::pair<unsigned short, unsigned short> coord = { static_cast<uint16_t>(pos - diff), i };
+            const size_t pos2 = text.find("]", pos);
+            if (pos2 == std::string::npos || pos2 >= line_end) break;
+            const std::pair<unsigned short, unsigned short> coord = { static_cast<uint16_t>(pos - line_start), i };
             link_coords_.push_back(coord);
-            const size_t pos2 = wiki_prc_.at(i).find("]", pos);
-            if (pos2 == std::string::npos) { link_coords_.erase(link_coords_.end() - 1); break; }
-            const std::string found = wiki_prc_.at(i).substr(pos + 1, pos2 - pos - 1);
+            const std::string found = text.substr(pos + 1, pos2 - pos - 1);
             link_str_.push_back(found);
-            start_pos = pos2;
+            start_pos = pos2 + 1;
             const std::vector<std::string> page_check = get_page(StrX::str_toupper(found));
             if (page_check.size() && page_check.at(0).size())
             {
@@ -423,9 +439,10 @@ void Wiki::render_wiki()
         if (end - buffer_pos_ > height) end = buffer_pos_ + height;
         for (unsigned int i = buffer_pos_; i < end; i++)
         {
-            bool centered = (wiki_prc_.at(i).size() > 3 && wiki_prc_.at(i).substr(0, 3) == "{e}");
-            terminal->print(wiki_prc_.at(i), centered ? (width / 2 - StrX::strlen_colour(wiki_prc_.at(i)) / 2) : 1, i - buffer_pos_ + 1,
-                Colour::WHITE, 0, wiki_window_);
+            const StyledText &raw = wiki_raw_.at(wiki_prc_.at(i).raw);
+            const StyledText::Line &line = wiki_prc_.at(i).line;
+            terminal->print(raw, is_centred(raw) ? (width / 2 - line.length / 2) : 1, i - buffer_pos_ + 1, Colour::WHITE, 0, wiki_window_, line.offset,
+                line.length);
             for (unsigned int j = 0; j < link_coords_.size(); j++)
             {
                 if (link_coords_.at(j).second == i)
@@ -484,8 +501,8 @@ void Wiki::wiki(const std::string &page)
     std::vector<std::string> header = get_page("WIKI_HEADER");
 
     for (auto line : header)
-        wiki_raw_.push_back("{e}" + line);
-    wiki_raw_.push_back(" ");
+        wiki_raw_.push_back(StyledText("{e}" + line));
+    wiki_raw_.push_back(StyledText(" "));
 
     std::vector<std::string> page_data = get_page(page);
     for (auto line : page_data)
@@ -493,8 +510,8 @@ void Wiki::wiki(const std::string &page)
         if (line.size())
         {
             bool zero_tag = (line.size() > 3 && line.substr(0, 3) == "{0}");
-            wiki_raw_.push_back(line.substr(zero_tag ? 3 : 0));
-            if (!zero_tag) wiki_raw_.push_back(" ");
+            wiki_raw_.push_back(StyledText(line.substr(zero_tag ? 3 : 0)));
+            if (!zero_tag) wiki_raw_.push_back(StyledText(" "));
         }
     }
     wiki_raw_.erase(wiki_raw_.end() - 1);
@@ -10,6 +10,8 @@
 #include <utility>
 #include <vector>
 
+#include "terminal/styled-text.hpp"
+
 
 namespace invictus
 {
@@ -23,8 +25,16 @@ public:
     static void wiki(); // Loads the in-game documentation.
 
 private:
+    // A single line in the processed wiki buffer.
+    struct WikiLine
+    {
+        uint32_t            raw;    // The line in the raw wiki buffer that this line is part of.
+        StyledText::Line    line;   // Which part of that line this is, once it's been word-wrapped.
+    };
+
     static void create_wiki_window();   // (re)creates the wiki render window.
     static std::vector<std::string> get_page(const std::string &page_name); // Gets a given page from the wiki.
+    static bool is_centred(const StyledText &raw);  // Checks if a line in the raw wiki buffer should be centred.
     static void process_key(int key);   // Processes input in the wiki window.
     static void process_wiki_buffer();  // Processes the wiki buffer after an update or screen resize.
     static void render_wiki();          // Redraws in the in-game wiki.
@@ -40,8 +50,8 @@ private:
     static std::vector<std::string> link_str_;      // Strings for the links.
     static std::map<std::string, std::vector<std::string>>  wiki_data_; // The pages in this wiki.
     static std::vector<std::string> wiki_history_;  // Previous wiki pages viewed.
-    static std::vector<std::string> wiki_prc_;      // The nicely processed wiki buffer, ready for rendering.
-    static std::vector<std::string> wiki_raw_;      // The raw, unprocessed wiki buffer.
+    static std::vector<WikiLine>    wiki_prc_;      // The nicely processed wiki buffer, word-wrapped and ready for rendering.
+    static std::vector<StyledText>  wiki_raw_;      // The raw wiki buffer, with each line's colour tags already parsed.
     static std::shared_ptr<Window>  wiki_window_;   // The wiki's render window.
 };
 
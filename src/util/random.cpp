@@ -1,8 +1,7 @@
 // util/random.cpp -- Random number generation utility code, to make RNG a little easier.
 // Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
 
-#include <cstdlib>
-#include <ctime>
+#include <random>
 
 #include "util/random.hpp"
 
@@ -10,40 +9,122 @@
 namespace invictus
 {
 
-bool Random::seeded_ = false;   // Has the RNG been seeded yet?
+/*******************************
+ * XOSHIRO256 CLASS DEFINITION *
+ *******************************/
+
+// Creates a new engine, seeded with the given value.
+Xoshiro256::Xoshiro256(uint64_t seed) { this->seed(seed); }
+
+// Generates an unbiased random number from 0 to range-1.
+uint32_t Xoshiro256::bounded(uint32_t range)
+{
+    if (range < 2) return 0;
+
+    // Lemire's multiply-and-shift method. The rare results which would favour the lower numbers are simply thrown away and rolled again.
+    uint64_t product = (next() >> 32) * range;
+    uint32_t low = static_cast<uint32_t>(product);
+    if (low < range)
+    {
+        const uint32_t threshold = (0U - range) % range;
+        while (low < threshold)
+        {
+            product = (next() >> 32) * range;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+// Generates the next raw 64-bit random number.
+uint64_t Xoshiro256::next()
+{
+    auto rotl = [](uint64_t x, int k) -> uint64_t { return (x << k) | (x >> (64 - k)); };
+    const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+    const uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl(state_[3], 45);
+    return result;
+}
+
+// Re-seeds this engine, expanding a single 64-bit seed into the full state.
+void Xoshiro256::seed(uint64_t seed)
+{
+    // SplitMix64 is the recommended way to fill the state, and guarantees it can't end up all zeroes.
+    for (int i = 0; i < 4; i++)
+    {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        state_[i] = z ^ (z >> 31);
+    }
+}
+
+
+/***************************
+ * RANDOM CLASS DEFINITION *
+ ***************************/
+
+bool        Random::seeded_ = false;    // Has the RNG been seeded yet?
+Xoshiro256  Random::streams_[static_cast<int>(RNG::_END)];  // The random number streams. These are only ever used on the main thread.
 
 // Generates a random number between, and including, the two specified values.
-unsigned int Random::rng(unsigned int min, unsigned int max)
+unsigned int Random::rng(unsigned int min, unsigned int max, RNG stream_id)
 {
     if (min >= max) return min;
-    if (!seeded_) seed();
-    return min + (std::rand() % (max - min + 1));
+    const uint32_t range = max - min + 1;
+    if (!range) return static_cast<unsigned int>(stream(stream_id).next() >> 32);   // The full 32-bit range was requested.
+    return min + stream(stream_id).bounded(range);
 }
 
 // As above, but with an implied minimum number of 1.
-unsigned int Random::rng(unsigned int max) { return rng(1, max); }
+unsigned int Random::rng(unsigned int max, RNG stream_id) { return rng(1, max, stream_id); }
 
 // 'Rolls' some virtual dice.
-unsigned int Random::roll(unsigned int num_dice, unsigned int num_faces)
+unsigned int Random::roll(unsigned int num_dice, unsigned int num_faces, RNG stream_id)
 {
     if (!num_dice || !num_faces) return 0;
     unsigned int result = 0;
 
     for (unsigned int i = 0; i < num_dice; i++)
-        result += rng(num_faces);
+        result += rng(num_faces, stream_id);
 
     return result;
 }
 
 // Retrieves a random float between the two specified values.
-float Random::rng_float(float min, float max) { return min + (static_cast<float>(std::rand()) / (RAND_MAX / (max - min))); }
+float Random::rng_float(float min, float max, RNG stream_id)
+{
+    // The top 24 bits fill a float's mantissa exactly, giving an even spread from 0 up to (but not including) 1.
+    const float unit = static_cast<float>(stream(stream_id).next() >> 40) * (1.0f / 16777216.0f);
+    return min + (unit * (max - min));
+}
 
 // Seed the random number generator.
 void Random::seed()
 {
-    std::srand((unsigned) std::time(NULL));
+    std::random_device rd;
+    seed((static_cast<uint64_t>(rd()) << 32) | rd());
+}
+
+// Seeds every random number stream from a single value, for reproducible results.
+void Random::seed(uint64_t seed)
+{
+    // Each stream gets its own seed, spaced far apart, so they never produce the same sequence.
+    for (int i = 0; i < static_cast<int>(RNG::_END); i++)
+        streams_[i].seed(seed + (static_cast<uint64_t>(i) * 0x632BE59BD9B4E019ULL));
     seeded_ = true;
 }
 
+// Retrieves a specified random number stream, seeding them all first if needed.
+Xoshiro256& Random::stream(RNG id)
+{
+    if (!seeded_) seed();
+    return streams_[static_cast<int>(id)];
+}
 
 }   // namespace invictus
@@ -4,20 +4,49 @@
 #ifndef UTIL_RANDOM_HPP_
 #define UTIL_RANDOM_HPP_
 
+#include <cstdint>
+
+
 namespace invictus
 {
 
+// The independent random number streams used by the game. Keeping these apart means that, for example, extra gore rolls don't change the outcome of combat.
+enum class RNG : uint8_t { MISC, AI, COMBAT, GORE, _END };
+
+
+// A small, fast xoshiro256** random number engine. Each instance is entirely self-contained, so separate instances can safely be used on separate threads.
+class Xoshiro256
+{
+public:
+                Xoshiro256(uint64_t seed = 0);  // Creates a new engine, seeded with the given value.
+    uint32_t    bounded(uint32_t range);    // Generates an unbiased random number from 0 to range-1.
+    uint64_t    next(); // Generates the next raw 64-bit random number.
+    void        seed(uint64_t seed);    // Re-seeds this engine, expanding a single 64-bit seed into the full state.
+
+private:
+    uint64_t    state_[4];  // The internal state of the generator.
+
+friend class SaveLoad;
+};
+
+
 class Random
 {
 public:
-    static unsigned int rng(unsigned int min, unsigned int max);    // Generates a random number between, and including, the two specified values.
-    static unsigned int rng(unsigned int max);  // As above, but with an implied minimum number of 1.
-    static float        rng_float(float min, float max);    // Retrieves a random float between the two specified values.
-    static unsigned int roll(unsigned int num_dice, unsigned int num_faces);    // 'Rolls' some virtual dice.
+    static unsigned int rng(unsigned int min, unsigned int max, RNG stream = RNG::MISC);    // Generates a random number between, and including, the two specified values.
+    static unsigned int rng(unsigned int max, RNG stream = RNG::MISC);  // As above, but with an implied minimum number of 1.
+    static float        rng_float(float min, float max, RNG stream = RNG::MISC);    // Retrieves a random float between the two specified values.
+    static unsigned int roll(unsigned int num_dice, unsigned int num_faces, RNG stream = RNG::MISC);    // 'Rolls' some virtual dice.
     static void         seed();     // Seed the random number generator.
+    static void         seed(uint64_t seed);    // Seeds every random number stream from a single value, for reproducible results.
 
 private:
-    static bool     seeded_;    // Has the RNG been seeded yet?
+    static Xoshiro256&  stream(RNG id); // Retrieves a specified random number stream, seeding them all first if needed.
+
+    static bool         seeded_;    // Has the RNG been seeded yet?
+    static Xoshiro256   streams_[static_cast<int>(RNG::_END)];  // The random number streams. These are only ever used on the main thread.
+
+friend class SaveLoad;
 };
 
 }       // namespace invictus
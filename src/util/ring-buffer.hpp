@@ -0,0 +1,55 @@
+// util/ring-buffer.hpp -- A fixed-capacity ring buffer, which keeps the most recent values added to it and quietly recycles the oldest once it's full.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef UTIL_RING_BUFFER_HPP_
+#define UTIL_RING_BUFFER_HPP_
+
+#include <cstddef>
+#include <vector>
+
+
+namespace invictus
+{
+
+template<class T> class RingBuffer
+{
+public:
+    explicit        RingBuffer(size_t capacity) : head_(0), size_(0), slots_(capacity) { }  // Constructor, allocates every slot up front.
+    T&              at(size_t index) { return slots_.at(slot(index)); }   // Retrieves a value, counting from the oldest.
+    const T&        at(size_t index) const { return slots_.at(slot(index)); } // As above, but read-only.
+    T&              back() { return at(size_ - 1); }    // Retrieves the newest value.
+    size_t          capacity() const { return slots_.size(); }  // Returns the maximum number of values that can be stored.
+    bool            empty() const { return !size_; }    // Checks if nothing is stored.
+    bool            full() const { return size_ == slots_.size(); } // Checks if the next value added will recycle the oldest.
+    size_t          size() const { return size_; }      // Returns the number of values stored.
+
+    // Removes every stored value.
+    void clear()
+    {
+        for (auto &value : slots_)
+            value = T();
+        head_ = size_ = 0;
+    }
+
+    // Adds a new value to the end, recycling the oldest if the buffer is full, and returns it to be filled in. The recycled value is not reset, so any
+    // memory it already holds can be reused.
+    T& push_back()
+    {
+        if (full()) head_ = (head_ + 1) % slots_.size();
+        else size_++;
+        return back();
+    }
+
+    // As above, but copies in a specified value.
+    void push_back(const T &value) { push_back() = value; }
+
+private:
+    size_t          slot(size_t index) const { return (head_ + index) % slots_.size(); }    // Converts an index into a slot number.
+
+    size_t          head_;  // The slot holding the oldest value.
+    size_t          size_;  // The number of values stored.
+    std::vector<T>  slots_; // Every slot, used or not.
+};
+
+}       // namespace invictus
+#endif  // UTIL_RING_BUFFER_HPP_
@@ -0,0 +1,140 @@
+// util/slot-map.hpp -- A generational slot map, which stores values in stable slots that can be looked up, added and removed in constant time.
+// Copyright © 2023 Raine "Gravecat" Simmons. Licensed under the GNU Affero General Public License v3 or any later version.
+
+#ifndef UTIL_SLOT_MAP_HPP_
+#define UTIL_SLOT_MAP_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+
+namespace invictus
+{
+
+// A handle to a value stored in a SlotMap. Each slot's generation changes whenever it's emptied, so a handle to a value which has since been removed can
+// never find whatever replaced it.
+struct SlotHandle
+{
+    uint32_t    index = 0;      // The slot the value is stored in.
+    uint32_t    generation = 0; // The generation of that slot when the value was stored.
+
+    bool    operator==(const SlotHandle &other) const { return index == other.index && generation == other.generation; }
+    bool    operator!=(const SlotHandle &other) const { return !(*this == other); }
+};
+
+
+template<class T> class SlotMap
+{
+private:
+    struct Slot
+    {
+        T           value;      // The value stored in this slot, if any.
+        uint32_t    generation; // Incremented every time this slot is emptied.
+        bool        occupied;   // Is anything stored in this slot right now?
+    };
+
+public:
+    // Iterates over the occupied slots, in slot order.
+    class const_iterator
+    {
+    public:
+                    const_iterator(const std::vector<Slot> *slots, uint32_t index) : index_(index), slots_(slots) { skip_empty(); }
+        const T&    operator*() const { return slots_->at(index_).value; }
+        const T*    operator->() const { return &slots_->at(index_).value; }
+        const_iterator& operator++() { index_++; skip_empty(); return *this; }
+        bool        operator==(const const_iterator &other) const { return index_ == other.index_; }
+        bool        operator!=(const const_iterator &other) const { return index_ != other.index_; }
+        SlotHandle  handle() const { return {index_, slots_->at(index_).generation}; }  // Returns the handle of the value this iterator points to.
+
+    private:
+        void        skip_empty() { while (index_ < slots_->size() && !slots_->at(index_).occupied) index_++; }  // Moves past any empty slots.
+
+        uint32_t    index_; // The slot this iterator points to.
+        const std::vector<Slot>     *slots_;    // The slots being iterated over.
+    };
+
+    const_iterator  begin() const { return const_iterator(&slots_, 0); }   // Returns an iterator to the first occupied slot.
+    bool            contains(SlotHandle handle) const   // Checks if a handle still refers to a stored value.
+    { return handle.index < slots_.size() && slots_[handle.index].occupied && slots_[handle.index].generation == handle.generation; }
+    const_iterator  end() const { return const_iterator(&slots_, slots_.size()); } // Returns an iterator past the last slot.
+    bool            occupied(uint32_t index) const { return index < slots_.size() && slots_[index].occupied; }  // Checks if a slot is in use, by its index.
+    size_t          size() const { return size_; }  // Returns the number of values stored.
+
+    // Removes every stored value. The slots are kept, so any old handles still can't find whatever is stored in them later.
+    void clear()
+    {
+        free_.clear();
+        for (uint32_t i = slots_.size(); i > 0; i--)
+        {
+            Slot &slot = slots_[i - 1];
+            if (slot.occupied)
+            {
+                slot.value = T();
+                slot.generation++;
+                slot.occupied = false;
+            }
+            free_.push_back(i - 1);
+        }
+        size_ = 0;
+    }
+
+    // Removes a stored value, freeing its slot for reuse. Returns false if the handle was no longer valid.
+    bool erase(SlotHandle handle)
+    {
+        if (!contains(handle)) return false;
+        Slot &slot = slots_[handle.index];
+        slot.value = T();
+        slot.generation++;
+        slot.occupied = false;
+        free_.push_back(handle.index);
+        size_--;
+        return true;
+    }
+
+    // Retrieves a stored value, or nullptr if the handle is no longer valid.
+    const T* get(SlotHandle handle) const { return (contains(handle) ? &slots_[handle.index].value : nullptr); }
+
+    // Stores a new value, reusing the most recently freed slot if there is one.
+    SlotHandle insert(T value)
+    {
+        uint32_t index = slots_.size();
+        if (free_.size())
+        {
+            index = free_.back();
+            free_.pop_back();
+        }
+        else slots_.push_back({T(), 0, false});
+        return fill(index, value);
+    }
+
+    // Stores a new value in a specific slot, which must be empty. Used when restoring values that were saved along with their slots.
+    SlotHandle insert_at(uint32_t index, T value)
+    {
+        while (slots_.size() <= index)
+        {
+            if (slots_.size() < index) free_.push_back(slots_.size());
+            slots_.push_back({T(), 0, false});
+        }
+        free_.erase(std::remove(free_.begin(), free_.end(), index), free_.end());
+        return fill(index, value);
+    }
+
+private:
+    // Stores a value in an empty slot.
+    SlotHandle fill(uint32_t index, T value)
+    {
+        Slot &slot = slots_[index];
+        slot.value = value;
+        slot.occupied = true;
+        size_++;
+        return {index, slot.generation};
+    }
+
+    std::vector<uint32_t>   free_;  // Empty slots, ready to be reused, with the most recently freed at the back.
+    std::vector<Slot>       slots_; // Every slot, occupied or not.
+    size_t                  size_ = 0;  // The number of occupied slots.
+};
+
+}       // namespace invictus
+#endif  // UTIL_SLOT_MAP_HPP_